@@ -0,0 +1,84 @@
+// Allocation checks, in their own executable: the global operator new is
+// replaced to count the allocations, and the unit tests must keep the
+// allocator of the platform.
+
+#define CATCH_CONFIG_MAIN
+#include "catch/catch.hpp"
+
+#include <PolygonTriangularization/poly_triang.hh>
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Allocations of this thread: the worker threads allocate concurrently.
+thread_local size_t alloc_nmbr = 0;
+}
+
+void* operator new(size_t _size)
+{
+  ++alloc_nmbr;
+  if (auto ptr = std::malloc(_size == 0 ? 1 : _size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* _ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+void operator delete(void* _ptr, size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+TEST_CASE("reuse", "[PolyTriang]")
+{
+  // Star shaped polygons, the last one with an island.
+  std::vector<std::vector<Geo::Vector3>> polys;
+  for (size_t pt_nmbr : { 3, 4, 12, 7, 40 })
+  {
+    polys.emplace_back();
+    for (size_t j = 0; j < pt_nmbr; ++j)
+    {
+      const double ang = 2 * M_PI * j / pt_nmbr;
+      const double rad = j % 2 == 0 ? 4 : 3;
+      polys.back().push_back({ rad * cos(ang), rad * sin(ang), 0 });
+    }
+  }
+  const std::vector<Geo::Vector3> island = {
+    { -1, -1, 0 }, { -1, 1, 0 }, { 1, 1, 0 }, { 1, -1, 0 } };
+
+  for (auto strat : { IPolygonTriangulation::Strategy::MIN_ANGLE,
+    IPolygonTriangulation::Strategy::EAR_CLIPPING })
+  {
+    auto ptg = IPolygonTriangulation::make(strat);
+    // The first turn sizes the buffers, the second one must reuse them.
+    for (int turn = 0; turn < 2; ++turn)
+    {
+      const auto alloc_start = alloc_nmbr;
+      for (const auto& plgn : polys)
+      {
+        ptg->reset();
+        ptg->add_view(plgn);
+        if (&plgn == &polys.back())
+          ptg->add(island);
+        const auto& tris = ptg->triangles();
+        if (&plgn == &polys.back())
+        {
+          REQUIRE(tris.size() == plgn.size() + 4);
+          REQUIRE(&ptg->polygon() != &plgn);
+        }
+        else
+        {
+          REQUIRE(tris.size() == plgn.size() - 2);
+          REQUIRE(&ptg->polygon() == &plgn);
+        }
+      }
+      if (turn == 1)
+        REQUIRE(alloc_nmbr == alloc_start);
+    }
+  }
+}
@@ -0,0 +1,380 @@
+// Triangulation benchmark: generates families of polygons of growing size
+// and reports, for every strategy, triangles per second, allocations per
+// triangulation and the scaling exponent (slope of log(time) / log(size)).
+//
+// benchmarks [-max_size N] [-max_size_min_angle N] [-min_time sec] [file.obj ...]
+//
+// The faces of the obj files are benchmarked as one more family.
+
+#include "PolygonTriangularization/poly_triang.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+// Allocations of all the threads, also the workers of a parallel split.
+std::atomic<size_t> alloc_nmbr(0);
+}
+
+void* operator new(size_t _size)
+{
+  alloc_nmbr.fetch_add(1, std::memory_order_relaxed);
+  if (auto ptr = std::malloc(_size == 0 ? 1 : _size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* _ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+void operator delete(void* _ptr, size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+namespace {
+
+typedef std::vector<Geo::Vector3> Loop;
+
+// Boundary followed by its islands.
+struct Polygon
+{
+  std::vector<Loop> loops_;
+  size_t point_number() const
+  {
+    size_t n = 0;
+    for (const auto& loop : loops_)
+      n += loop.size();
+    return n;
+  }
+  // Triangles of a triangulation without added points.
+  size_t expected_triangles() const
+  {
+    return point_number() + 2 * (loops_.size() - 1) - 2;
+  }
+};
+
+const double PI = 3.14159265358979323846;
+
+Loop regular(size_t _n, double _rad_even, double _rad_odd)
+{
+  Loop loop;
+  for (size_t i = 0; i < _n; ++i)
+  {
+    const double ang = 2 * PI * i / _n;
+    const double rad = i % 2 == 0 ? _rad_even : _rad_odd;
+    loop.push_back({ rad * std::cos(ang), rad * std::sin(ang), 0 });
+  }
+  return loop;
+}
+
+Polygon convex(size_t _n)
+{
+  return Polygon{ { regular(_n, 1, 1) } };
+}
+
+Polygon star(size_t _n)
+{
+  return Polygon{ { regular(_n + _n % 2, 2, 1) } };
+}
+
+// Band of width 1 wound along an archimedean spiral with pitch 2.
+Polygon spiral(size_t _n)
+{
+  const size_t side = std::max<size_t>(_n / 2, 4);
+  const size_t turn_smpl = 64;
+  const double turns = std::max(1., double(side) / turn_smpl);
+  Loop outer, inner;
+  for (size_t i = 0; i < side; ++i)
+  {
+    const double t = 2 * PI * (1 + turns * i / (side - 1));
+    const double rad = 1 + t / PI;
+    outer.push_back({ (rad + 0.5) * std::cos(t), (rad + 0.5) * std::sin(t), 0 });
+    inner.push_back({ (rad - 0.5) * std::cos(t), (rad - 0.5) * std::sin(t), 0 });
+  }
+  outer.insert(outer.end(), inner.rbegin(), inner.rend());
+  return Polygon{ { outer } };
+}
+
+// Base with n / 4 teeth of width 1 and height 10.
+Polygon comb(size_t _n)
+{
+  const size_t teeth = std::max<size_t>(_n / 4, 1);
+  Loop loop{ { 0, 0, 0 }, { 2. * teeth - 1, 0, 0 } };
+  for (auto i = teeth; i-- > 0;)
+  {
+    loop.push_back({ 2. * i + 1, 10, 0 });
+    loop.push_back({ 2. * i, 10, 0 });
+    if (i > 0)
+    {
+      loop.push_back({ 2. * i, 1, 0 });
+      loop.push_back({ 2. * i - 1, 1, 0 });
+    }
+  }
+  return Polygon{ { loop } };
+}
+
+// Square plate with a grid of about n / 4 square holes.
+Polygon holes(size_t _n)
+{
+  const auto row_nmbr = size_t(std::ceil(std::sqrt(std::max<size_t>(_n / 4, 1))));
+  const double side = 3. * row_nmbr;
+  Polygon poly;
+  poly.loops_.push_back({ { 0, 0, 0 }, { side, 0, 0 }, { side, side, 0 }, { 0, side, 0 } });
+  for (size_t i = 0; i < row_nmbr; ++i)
+  {
+    for (size_t j = 0; j < row_nmbr; ++j)
+    {
+      const double x = 3. * i + 1, y = 3. * j + 1;
+      poly.loops_.push_back(
+        { { x, y, 0 }, { x, y + 1, 0 }, { x + 1, y + 1, 0 }, { x + 1, y, 0 } });
+    }
+  }
+  return poly;
+}
+
+// Square with many collinear points on the sides, moved by a tiny amount.
+Polygon near_degenerate(size_t _n)
+{
+  const size_t side_pts = std::max<size_t>(_n / 4, 1);
+  const Geo::Vector3 corners[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+  Loop loop;
+  for (size_t s = 0; s < 4; ++s)
+  {
+    const auto& a = corners[s];
+    const auto& b = corners[(s + 1) % 4];
+    for (size_t i = 0; i < side_pts; ++i)
+    {
+      auto pt = a + (b - a) * (double(i) / side_pts);
+      pt[2] = i % 3 == 1 ? 1e-12 : 0;
+      loop.push_back(pt);
+    }
+  }
+  return Polygon{ { loop } };
+}
+
+// Star on a wavy surface.
+Polygon non_planar(size_t _n)
+{
+  auto loop = regular(_n + _n % 2, 2, 1);
+  for (auto& pt : loop)
+    pt[2] = 0.1 * std::sin(3 * pt[0]) * std::cos(2 * pt[1]);
+  return Polygon{ { loop } };
+}
+
+// Faces of an obj file, islands are not supported by the format.
+std::vector<Polygon> load_faces(const char* _flnm)
+{
+  std::vector<Polygon> faces;
+  std::ifstream in(_flnm);
+  std::vector<Geo::Vector3> verts;
+  std::string line, tok;
+  while (std::getline(in, line))
+  {
+    std::istringstream ss(line);
+    ss >> tok;
+    if (tok == "v")
+    {
+      Geo::Vector3 pt;
+      ss >> pt[0] >> pt[1] >> pt[2];
+      verts.push_back(pt);
+    }
+    else if (tok == "f")
+    {
+      Loop loop;
+      while (ss >> tok)
+      {
+        const auto idx = std::atoi(tok.c_str());
+        loop.push_back(verts[idx > 0 ? idx - 1 : verts.size() + idx]);
+      }
+      faces.push_back(Polygon{ { loop } });
+    }
+  }
+  return faces;
+}
+
+// Averages per polygon.
+struct Result
+{
+  double pt_nmbr_ = 0;
+  double tri_nmbr_ = 0;
+  size_t bad_ = 0;       // Polygons with an unexpected triangle count or an error.
+  double time_ = 0;      // Seconds.
+  double first_allocs_ = 0;
+  double allocs_ = 0;    // With warm buffers.
+};
+
+// Triangulates the polygons again and again with the same triangulator,
+// for at least _min_time seconds.
+Result run(IPolygonTriangulation& _ptg, const std::vector<Polygon>& _polys,
+  double _min_time)
+{
+  Result res;
+  auto pass = [&_ptg, &_polys, &res](bool _check)
+  {
+    for (const auto& poly : _polys)
+    {
+      _ptg.reset();
+      for (const auto& loop : poly.loops_)
+        _ptg.add_view(loop);
+      try
+      {
+        const auto tri_nmbr = _ptg.triangles().size();
+        if (_check)
+        {
+          res.pt_nmbr_ += poly.point_number();
+          res.tri_nmbr_ += tri_nmbr;
+          res.bad_ += tri_nmbr != poly.expected_triangles();
+        }
+      }
+      catch (const char*)
+      {
+        res.bad_ += _check;
+      }
+    }
+  };
+  size_t allocs = alloc_nmbr;
+  pass(true);
+  const double poly_nmbr = double(_polys.size());
+  res.pt_nmbr_ /= poly_nmbr;
+  res.tri_nmbr_ /= poly_nmbr;
+  res.first_allocs_ = (alloc_nmbr - allocs) / poly_nmbr;
+
+  typedef std::chrono::steady_clock Clock;
+  size_t pass_nmbr = 0;
+  allocs = alloc_nmbr;
+  const auto start = Clock::now();
+  double elapsed = 0;
+  do
+  {
+    pass(false);
+    ++pass_nmbr;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (elapsed < _min_time);
+  res.allocs_ = (alloc_nmbr - allocs) / (pass_nmbr * poly_nmbr);
+  res.time_ = elapsed / (pass_nmbr * poly_nmbr);
+  return res;
+}
+
+// Least squares slope of log(time) over log(points).
+double scaling_exponent(const std::vector<Result>& _res)
+{
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+  size_t n = 0;
+  for (const auto& res : _res)
+  {
+    if (res.time_ <= 0 || res.pt_nmbr_ == 0)
+      continue;
+    const auto x = std::log(res.pt_nmbr_);
+    const auto y = std::log(res.time_);
+    sx += x; sy += y; sxx += x * x; sxy += x * y;
+    ++n;
+  }
+  const auto den = n * sxx - sx * sx;
+  if (n < 2 || den <= 0)
+    return 0;
+  return (n * sxy - sx * sy) / den;
+}
+
+void print_header()
+{
+  std::printf("%-16s %-13s %9s %9s %11s %12s %13s %5s\n", "family", "strategy",
+    "points", "tris", "time(s)", "tris/s", "allocs", "bad");
+}
+
+void print(const char* _family, const char* _strat, const Result& _res)
+{
+  std::printf("%-16s %-13s %9.1f %9.1f %11.3e %12.4g %6.0f/%-6.1f %5zu\n",
+    _family, _strat, _res.pt_nmbr_, _res.tri_nmbr_, _res.time_,
+    _res.tri_nmbr_ / _res.time_, _res.first_allocs_, _res.allocs_, _res.bad_);
+}
+
+}//namespace
+
+int main(int _argc, char* _argv[])
+{
+  size_t max_size = 4096;
+  size_t max_size_min_angle = 1024; // MIN_ANGLE is cubic.
+  double min_time = 0.2;
+  std::vector<const char*> obj_files;
+  for (int i = 1; i < _argc; ++i)
+  {
+    if (std::strcmp(_argv[i], "-max_size") == 0 && i + 1 < _argc)
+      max_size = std::strtoul(_argv[++i], nullptr, 10);
+    else if (std::strcmp(_argv[i], "-max_size_min_angle") == 0 && i + 1 < _argc)
+      max_size_min_angle = std::strtoul(_argv[++i], nullptr, 10);
+    else if (std::strcmp(_argv[i], "-min_time") == 0 && i + 1 < _argc)
+      min_time = std::atof(_argv[++i]);
+    else
+      obj_files.push_back(_argv[i]);
+  }
+
+  struct Family
+  {
+    const char* name_;
+    std::function<Polygon(size_t)> make_;
+  };
+  const Family families[] = {
+    { "convex", convex },
+    { "star", star },
+    { "spiral", spiral },
+    { "comb", comb },
+    { "holes", holes },
+    { "near_degenerate", near_degenerate },
+    { "non_planar", non_planar } };
+
+  typedef IPolygonTriangulation::Strategy Strategy;
+  const char* STRAT_NAMES[] = { "MIN_ANGLE", "MONOTONE", "EAR_CLIPPING" };
+  print_header();
+  for (const auto& fam : families)
+  {
+    const bool is_holes = std::strcmp(fam.name_, "holes") == 0;
+    for (size_t s = 0; s < size_t(Strategy::ENUM_SIZE); ++s)
+    {
+      const auto strat = Strategy(s);
+      auto max_n = strat == Strategy::MIN_ANGLE ? max_size_min_angle :
+        is_holes ? 10 * max_size : max_size; // About 10k islands by default.
+      auto ptg = IPolygonTriangulation::make(strat);
+      std::vector<Result> results;
+      std::vector<size_t> sizes;
+      for (size_t n = 16; n < max_n; n *= 4)
+        sizes.push_back(n);
+      sizes.push_back(max_n);
+      for (auto n : sizes)
+      {
+        // Many copies of the small polygons to measure a reasonable time.
+        const std::vector<Polygon> polys(std::max<size_t>(1, 1024 / n), fam.make_(n));
+        results.push_back(run(*ptg, polys, min_time));
+        print(fam.name_, STRAT_NAMES[s], results.back());
+      }
+      std::printf("%-16s %-13s scaling exponent %.2f\n\n", fam.name_,
+        STRAT_NAMES[s], scaling_exponent(results));
+    }
+  }
+
+  for (auto flnm : obj_files)
+  {
+    const auto faces = load_faces(flnm);
+    if (faces.empty())
+      continue;
+    for (size_t s = 0; s < size_t(Strategy::ENUM_SIZE); ++s)
+    {
+      const auto strat = Strategy(s);
+      auto ptg = IPolygonTriangulation::make(strat);
+      print(flnm, STRAT_NAMES[s], run(*ptg, faces, min_time));
+    }
+  }
+  return 0;
+}
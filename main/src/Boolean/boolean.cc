@@ -1,6 +1,8 @@
 
 #include "boolean.hh"
 #include "priv.hh"
+#include <Topology/edge_table.hh>
+#include <Topology/half_edge.hh>
 #include <Topology/iterator.hh>
 #include <Topology/impl.hh>
 
@@ -31,6 +33,10 @@ struct BodyInfo : public
   void init(Topo::Wrap<Topo::Type::BODY> _body)
   {
     body_ = _body;
+    // The adjacency queries of the intersections use them, the edits of
+    // the splits keep them up to date.
+    Topo::add_half_edge_index(body_);
+    Topo::add_edge_table(body_);
   }
 
   template <Topo::Type typeT>
@@ -154,6 +160,8 @@ Topo::Wrap<Topo::Type::BODY> Solver::make_result()
       new_body_data->insert_child(ent);
       bodies_[i].body_->remove_child(ind);
     }
+    Topo::remove_half_edge_index(bodies_[i].body_);
+    Topo::remove_edge_table(bodies_[i].body_);
   }
   return new_body;
 }
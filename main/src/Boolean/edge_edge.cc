@@ -4,6 +4,8 @@
 #include "Topology/iterator.hh"
 #include "Topology/impl.hh"
 #include "Topology/split.hh"
+#include "Topology/transaction.hh"
+#include "Topology/view.hh"
 #include "Geo/entity.hh"
 #include "Geo/vector.hh"
 #include "Geo/minsphere.hh"
@@ -11,8 +13,8 @@
 #include "Utils/merger.hh"
 
 #include "Utils/error_handling.hh"
+#include "Utils/flat_hash.hh"
 
-#include <set>
 #include <limits>
 
 namespace Boolean {
@@ -117,16 +119,19 @@ bool EdgeVersusEdges::intersect(
 {
   struct IntersectionData
   {
-    Topo::Wrap<Topo::Type::EDGE> edge_;
+    // Borrowed from the iterators, that keep the edges.
+    Topo::Ref<Topo::Type::EDGE> edge_;
     Geo::Segment seg_;
-    Topo::Iterator<Topo::Type::EDGE, Topo::Type::VERTEX> ev_it_;
+    Topo::Ref<Topo::Type::VERTEX> verts_[2];
     double tol_ = 0;
 
-    void set_edge(const Topo::Wrap<Topo::Type::EDGE>& _edge)
+    void set_edge(Topo::Ref<Topo::Type::EDGE> _edge)
     {
       edge_ = _edge;
       edge_->geom(seg_);
-      ev_it_.reset(edge_);
+      Topo::View<Topo::Type::EDGE, Topo::Type::VERTEX> ev(edge_);
+      for (size_t i = 0; i < 2; ++i)
+        verts_[i] = ev[i];
       tol_ = edge_->tolerance();
     }
 
@@ -135,13 +140,13 @@ bool EdgeVersusEdges::intersect(
       std::shared_ptr<Topo::Wrap<Topo::Type::VERTEX>>& _vert)
     {
       Geo::Point vert_pt;
-      for (size_t j = 0; j < ev_it_.size(); ++j)
+      for (const auto& vert : verts_)
       {
-        ev_it_.get(j)->geom(vert_pt);
+        vert->geom(vert_pt);
         if (!Geo::same(vert_pt, _clsst_pt, _tol))
           continue;
         _splt_info.on_end = true;
-        _vert = std::make_shared<Topo::Wrap<Topo::Type::VERTEX>>(ev_it_.get(j));
+        _vert = std::make_shared<Topo::Wrap<Topo::Type::VERTEX>>(vert.wrap());
         return true;
       }
       return false;
@@ -149,19 +154,19 @@ bool EdgeVersusEdges::intersect(
 
   } intrs_dat[2];
 
-  for (size_t i = 0; i < _ed_it_a.size(); ++i)
+  for (const auto& edge_a : _ed_it_a)
   {
-    intrs_dat[0].set_edge(_ed_it_a.get(i));
-    for (size_t j = 0; j < _ed_it_b.size(); ++j)
+    intrs_dat[0].set_edge(edge_a);
+    for (const auto& edge_b : _ed_it_b)
     {
-      intrs_dat[1].set_edge(_ed_it_b.get(j));
+      intrs_dat[1].set_edge(edge_b);
 
       std::vector<std::array<size_t, 2>> matches;
-      for (size_t k = 0; k < intrs_dat[0].ev_it_.size(); ++k)
+      for (size_t k = 0; k < 2; ++k)
       {
-        for (size_t l = 0; l < intrs_dat[1].ev_it_.size(); ++l)
+        for (size_t l = 0; l < 2; ++l)
         {
-          if (intrs_dat[0].ev_it_.get(k) == intrs_dat[1].ev_it_.get(l))
+          if (intrs_dat[0].verts_[k] == intrs_dat[1].verts_[l])
           {
             matches.push_back({ k, l });
             break;
@@ -202,11 +207,11 @@ bool EdgeVersusEdges::intersect(
 
       for (size_t k = 0; k < 2; ++k)
       {
-        ed_ed_splt_inf.ed_split_info_[k].edge_ = intrs_dat[k].edge_;
+        ed_ed_splt_inf.ed_split_info_[k].edge_ = intrs_dat[k].edge_.wrap();
         ed_ed_splt_inf.ed_split_info_[k].par = pars[k];
       }
       ed_ed_splt_inf.tol_ = max_tol();
-      splt_infos_.push_back(ed_ed_splt_inf);
+      splt_infos_.push_back(std::move(ed_ed_splt_inf));
     }
   }
   return true;
@@ -216,7 +221,7 @@ bool EdgeVersusEdges::split()
 {
   merge_intersections(splt_infos_);
 
-  std::set<Topo::Split<Topo::Type::EDGE>> ed_splt_set;
+  Utils::FlatHashSet<Topo::Split<Topo::Type::EDGE>> ed_splt_set;
   for (auto& splt_info : splt_infos_)
   {
     if (!splt_info.vert_)
@@ -243,9 +248,7 @@ bool EdgeVersusEdges::split()
           continue;
       }
 
-      auto it = ed_splt_set.lower_bound(ed_split.edge_);
-      if (it == ed_splt_set.end() || *it != ed_split.edge_)
-        it = ed_splt_set.emplace_hint(it, ed_split.edge_);
+      auto it = ed_splt_set.emplace(ed_split.edge_).first;
 
       Topo::Split<Topo::Type::EDGE>::Info ed_split_info;
       ed_split_info.vert_ = *splt_info.vert_;
@@ -254,8 +257,10 @@ bool EdgeVersusEdges::split()
       it->add_point(ed_split_info);
     }
   }
-  for (auto split_op : ed_splt_set)
-    split_op();
+  Topo::Transaction trans;
+  for (const auto& split_op : ed_splt_set)
+    split_op(trans);
+  trans.commit();
   return true;
 }
 
@@ -1,12 +1,13 @@
 
 #include "Boolean/priv.hh"
+#include "Utils/flat_hash.hh"
 #include "Utils/statistics.hh"
 #include "Topology/iterator.hh"
 #include "Topology/split.hh"
+#include "Topology/transaction.hh"
+#include "Topology/view.hh"
 #include "Geo/entity.hh"
 
-#include <set>
-
 namespace Boolean {
 
 namespace {
@@ -17,7 +18,7 @@ struct EdgesVersusVertices : public IEdgesVersusVertices
     Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE>& _ed_it_b);
   virtual bool split();
 private:
-  std::set<Topo::Split<Topo::Type::EDGE>> ed_splt_set_;
+  Utils::FlatHashSet<Topo::Split<Topo::Type::EDGE>> ed_splt_set_;
 };
 
 
@@ -25,20 +26,15 @@ bool EdgesVersusVertices::intersect(
   Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX>& _vert_it,
   Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE>& _ed_it)
 {
-  for (size_t i = 0; i < _ed_it.size(); ++i)
+  for (auto& edge : _ed_it)
   {
-    Topo::Wrap<Topo::Type::EDGE> edge = _ed_it.get(i);
-    Topo::Iterator<Topo::Type::EDGE, Topo::Type::VERTEX> ev;
-    ev.reset(edge);
-    for (size_t j = 0; j < _vert_it.size(); ++j)
+    Topo::View<Topo::Type::EDGE, Topo::Type::VERTEX> ev(edge);
+    for (const auto& vert : _vert_it)
     {
-      Topo::Split<Topo::Type::EDGE>::Info spli;
-      spli.vert_ = _vert_it.get(j);
-
       bool found = false;
       for (auto k = ev.size(); k-- > 0; )
       {
-        if (ev.get(k) == spli.vert_)
+        if (*ev[k] == *vert.get())
         {
           found = true;
           break;
@@ -47,20 +43,19 @@ bool EdgesVersusVertices::intersect(
       if (found)
         continue;  // The vertex is already on the edge.
 
+      Topo::Split<Topo::Type::EDGE>::Info spli;
       Geo::Point pt;
-      spli.vert_->geom(pt);
+      vert->geom(pt);
       Geo::Segment seg;
       edge->geom(seg);
       Geo::closest_point(seg, pt, &spli.clsst_pt_, &spli.t_, &spli.dist_);
-      Utils::FindMax<double> max_tol(spli.vert_->tolerance());
+      Utils::FindMax<double> max_tol(vert->tolerance());
       max_tol.add(edge->tolerance());
       if (spli.dist_ > max_tol())
         continue; // Vertex is too far.
+      spli.vert_ = vert;
 
-      auto it = ed_splt_set_.lower_bound(edge);
-      if (it == ed_splt_set_.end() || *it != edge)
-        it = ed_splt_set_.emplace_hint(it, edge);
-      it->add_point(spli);
+      ed_splt_set_.emplace(edge).first->add_point(spli);
     }
   }
   return true;
@@ -68,8 +63,10 @@ bool EdgesVersusVertices::intersect(
 
 bool EdgesVersusVertices::split()
 {
-  for (auto split_op : ed_splt_set_)
-    split_op();
+  Topo::Transaction trans;
+  for (const auto& split_op : ed_splt_set_)
+    split_op(trans);
+  trans.commit();
   return true;
 }
 
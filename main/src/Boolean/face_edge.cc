@@ -3,22 +3,22 @@
 #include "Geo/MinSphere.hh"
 #include "Topology/split.hh"
 #include "Topology/impl.hh"
+#include "Topology/view.hh"
 #include "Utils/index.hh"
+#include "Utils/flat_hash.hh"
 #include "Utils/merger.hh"
 
-#include <set>
-
 namespace Boolean {
 
 namespace {
 
 struct FaceEdgeInfo
 {
-  std::map<Topo::Wrap<Topo::Type::FACE>, std::vector<Utils::Index>> f_v_refs_;
+  Utils::FlatHashMap<Topo::Wrap<Topo::Type::FACE>, std::vector<Utils::Index>> f_v_refs_;
 
   typedef double Parameter;
   typedef std::tuple<Utils::Index, Parameter> EdgeVertexReference;
-  std::map<Topo::Wrap<Topo::Type::EDGE>, std::vector<EdgeVertexReference>> e_v_refs_;
+  Utils::FlatHashMap<Topo::Wrap<Topo::Type::EDGE>, std::vector<EdgeVertexReference>> e_v_refs_;
 
   struct VertexReferences : public Utils::Mergiable
   {
@@ -27,8 +27,8 @@ struct FaceEdgeInfo
     double tol_;
     Topo::Wrap<Topo::Type::VERTEX> vert_;
     std::vector<Geo::Point> mrg_list_;
-    std::set<Topo::Wrap<Topo::Type::EDGE>> edge_refs_;
-    std::set<Topo::Wrap<Topo::Type::FACE>> face_refs_;
+    Utils::FlatHashSet<Topo::Wrap<Topo::Type::EDGE>> edge_refs_;
+    Utils::FlatHashSet<Topo::Wrap<Topo::Type::FACE>> face_refs_;
     FaceEdgeInfo* owner_;
 
     bool equivalent(const VertexReferences& _oth) const;
@@ -144,6 +144,7 @@ bool FaceVersus::edge_intersect(
   Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE>& _edge_it)
 {
   FaceEdgeInfo f_eds_info;
+  face_geoms(_face_it);
   for (auto& face : _face_it)
   {
     auto& face_info = face_geom(face);
@@ -159,8 +160,7 @@ bool FaceVersus::edge_intersect(
         continue;
 
       bool point_on_vertex = false;
-      Topo::Iterator<Topo::Type::EDGE, Topo::Type::VERTEX> ev_it(edge);
-      for (auto vert : ev_it)
+      for (auto vert : Topo::View<Topo::Type::EDGE, Topo::Type::VERTEX>(edge))
       {
         Geo::Point pt;
         vert->geom(pt);
@@ -7,23 +7,26 @@
 #include <Topology/split.hh>
 #include "Topology/connect.hh"
 #include "Utils/error_handling.hh"
+#include "Utils/flat_hash.hh"
 
+#include <algorithm>
 #include <list>
-#include <set>
 
 namespace Boolean {
 
 namespace {
 
-std::set<Topo::Wrap<Topo::Type::VERTEX>> face_vertices(
+// Vertices of the face and the new ones on it, sorted without repetitions.
+std::vector<Topo::Wrap<Topo::Type::VERTEX>> face_vertices(
   const std::vector<Topo::Wrap<Topo::Type::VERTEX>>& _verts,
   const Topo::Wrap<Topo::Type::FACE>& _face_a)
 {
-  std::set<Topo::Wrap<Topo::Type::VERTEX>> vert_set;
-  vert_set.insert(_verts.begin(), _verts.end());
+  std::vector<Topo::Wrap<Topo::Type::VERTEX>> verts(_verts);
   Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv_it(_face_a);
-  vert_set.insert(fv_it.begin(), fv_it.end());
-  return vert_set;
+  verts.insert(verts.end(), fv_it.begin(), fv_it.end());
+  std::sort(verts.begin(), verts.end());
+  verts.erase(std::unique(verts.begin(), verts.end()), verts.end());
+  return verts;
 }
 
 struct FaceEdgeMap
@@ -35,7 +38,8 @@ struct FaceEdgeMap
   bool add_face_edge(
     const Topo::Wrap<Topo::Type::FACE>& _face,
     const std::vector<Topo::Wrap<Topo::Type::VERTEX>>& _v_inters,
-    bool _is_face_b)
+    bool _is_face_b,
+    const Geo::IPolygonalFace& _pl_geom)
   {
     auto& map = map_[_is_face_b];
     auto elem = map.emplace(_face, FaceData());
@@ -48,17 +52,15 @@ struct FaceEdgeMap
       Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv_it(_face);
       auto pl_fit = Geo::IPlaneFit::make();
       pl_fit->init(fv_it.size());
-      std::vector<Geo::Point> face_pts;
       for (auto vert : fv_it)
       {
-        face_pts.emplace_back();
-        vert->geom(face_pts.back());
-        pl_fit->add_point(face_pts.back());
+        Geo::Point pt;
+        vert->geom(pt);
+        pl_fit->add_point(pt);
       }
       Geo::Point c, n;
       pl_fit->compute(c, n);
-      auto pl_geom = Geo::IPolygonalFace::make(face_pts.begin(), face_pts.end());
-      if (pl_geom->normal() * n < 0)
+      if (_pl_geom.normal() * n < 0)
         n = -n;
       std::get<Normal>(data) = n;
     }
@@ -74,7 +76,7 @@ private:
   typedef Geo::Point Normal;
 
   typedef std::tuple<Normal, NewFaces, NewEdges> FaceData;
-  std::map<Topo::Wrap<Topo::Type::FACE>, FaceData> map_[2];
+  Utils::FlatHashMap<Topo::Wrap<Topo::Type::FACE>, FaceData> map_[2];
 };
 
 } //namespace
@@ -85,23 +87,35 @@ bool FaceVersus::face_intersect(
   Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE>& _face_it_b)
 {
   FaceEdgeMap face_new_edge_map;
-  for (auto face_a : _face_it_a)
+  // The vertices of the faces b are sorted once, the common vertices are
+  // found looking them up in the hash set of the face a.
+  std::vector<std::vector<Topo::Wrap<Topo::Type::VERTEX>>> verts_b;
+  verts_b.reserve(_face_it_b.size());
+  for (const auto& face_b : _face_it_b)
+    verts_b.push_back(face_vertices(f_vert_info_[face_b].new_vert_list_, face_b));
+  Utils::FlatHashSet<Topo::Wrap<Topo::Type::VERTEX>> vert_set_a;
+  std::vector<Topo::Wrap<Topo::Type::VERTEX>> v_inters;
+  for (const auto& face_a : _face_it_a)
   {
-    auto vert_set_a = face_vertices(f_vert_info_[face_a].new_vert_list_, face_a);
-    for (auto face_b : _face_it_b)
+    vert_set_a.clear();
+    for (const auto& vert : face_vertices(f_vert_info_[face_a].new_vert_list_, face_a))
+      vert_set_a.insert(vert);
+    for (size_t i = 0; i < _face_it_b.size(); ++i)
     {
-      const auto& vert_set_b = 
-        face_vertices(f_vert_info_[face_b].new_vert_list_, face_b);
-      std::vector<Topo::Wrap<Topo::Type::VERTEX>> v_inters;
-      std::set_intersection(
-        vert_set_a.begin(), vert_set_a.end(),
-        vert_set_b.begin(), vert_set_b.end(),
-        std::back_inserter(v_inters));
+      const auto& face_b = _face_it_b.begin()[i];
+      v_inters.clear();
+      for (const auto& vert : verts_b[i])
+      {
+        if (vert_set_a.count(vert) > 0)
+          v_inters.push_back(vert);
+      }
       if (v_inters.size() < 2)
         continue;
 
-      face_new_edge_map.add_face_edge(face_a, v_inters, false);
-      face_new_edge_map.add_face_edge(face_b, v_inters, true);
+      face_new_edge_map.add_face_edge(
+        face_a, v_inters, false, *face_geom(face_a).poly_face_);
+      face_new_edge_map.add_face_edge(
+        face_b, v_inters, true, *face_geom(face_b).poly_face_);
     }
   }
   face_new_edge_map.init_map();
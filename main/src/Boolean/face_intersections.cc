@@ -3,32 +3,64 @@
 #include "priv.hh"
 
 #include "Topology/impl.hh"
+#include "Topology/view.hh"
 #include "Geo/entity.hh"
 #include "Geo/pow.hh"
 #include "Geo/vector.hh"
 #include "Utils/merger.hh"
 
-#include<map>
 #include<vector>
-#include<set>
 
 namespace Boolean {
 
+namespace {
+
+void face_points(const Topo::Wrap<Topo::Type::FACE>& _face,
+  std::vector<Geo::Point>& _pts)
+{
+  _pts.clear();
+  for (auto vert : Topo::View<Topo::Type::FACE, Topo::Type::VERTEX>(_face))
+  {
+    _pts.emplace_back();
+    vert->geom(_pts.back());
+  }
+}
+
+}//namespace
+
 FaceVersus::FaceVertexInfo& 
 FaceVersus::face_geom(const Topo::Wrap<Topo::Type::FACE>& _face)
 {
   auto& geom = f_vert_info_[_face];
   if (!geom.poly_face_)
   {
-    Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv_it(_face);
-    std::vector<Geo::Point> pts(fv_it.size());
-    for (size_t i = 0; i < fv_it.size(); ++i)
-      fv_it.get(i)->geom(pts[i]);
+    std::vector<Geo::Point> pts;
+    face_points(_face, pts);
     geom.poly_face_ = Geo::IPolygonalFace::make(pts.begin(), pts.end());
   }
   return geom;
 }
 
+void FaceVersus::face_geoms(
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE>& _face_it)
+{
+  std::vector<Topo::Wrap<Topo::Type::FACE>> faces;
+  std::vector<std::vector<Geo::Point>> polys;
+  f_vert_info_.reserve(f_vert_info_.size() + _face_it.size());
+  for (auto& face : _face_it)
+  {
+    if (f_vert_info_[face].poly_face_)
+      continue;
+    faces.push_back(face);
+    polys.emplace_back();
+    face_points(face, polys.back());
+  }
+  auto poly_faces = Geo::IPolygonalFace::make_all(polys);
+  // The insertions move the values of the map: no reference is kept above.
+  for (size_t i = 0; i < faces.size(); ++i)
+    f_vert_info_[faces[i]].poly_face_ = poly_faces[i];
+}
+
 std::shared_ptr<IFaceVersus> IFaceVersus::make() { return std::make_shared<FaceVersus>(); }
 
 }//namespace Boolean
@@ -1,10 +1,9 @@
 #pragma once
 
 #include "priv.hh"
-//#include "UtilsIndex.h"
+#include "Utils/flat_hash.hh"
 
 #include <memory>
-#include <map>
 #include <vector>
 
 
@@ -38,8 +37,10 @@ private:
   };
 
   FaceVertexInfo& face_geom(const Topo::Wrap<Topo::Type::FACE>& _face);
+  // Computes the geometry of all the faces at once.
+  void face_geoms(Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE>& _face_it);
 
-  std::map<Topo::Wrap<Topo::Type::FACE>, FaceVertexInfo> f_vert_info_;
+  Utils::FlatHashMap<Topo::Wrap<Topo::Type::FACE>, FaceVertexInfo> f_vert_info_;
 
   OverlapFces overlap_faces_;
 };
@@ -1,8 +1,7 @@
 
 #include "face_intersections.hh"
 #include "Geo/pow.hh"
-
-#include <set>
+#include "Utils/flat_hash.hh"
 
 namespace Boolean {
 
@@ -10,14 +9,16 @@ bool FaceVersus::vertex_intersect(
   Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE>& _face_it,
   Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX>& _vert_it)
 {
+  face_geoms(_face_it);
   for (auto& face : _face_it)
   {
     Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv_it(face);
-    std::set<Topo::Wrap<Topo::Type::VERTEX>> face_verts(fv_it.begin(), fv_it.end());
+    Utils::FlatHashSet<Topo::Wrap<Topo::Type::VERTEX>> face_verts;
+    face_verts.insert(fv_it.begin(), fv_it.end());
     auto& face_info = face_geom(face);
     for (auto& vert : _vert_it)
     {
-      if (face_verts.find(vert) != face_verts.end())
+      if (face_verts.count(vert) > 0)
         continue;
       Geo::Point pt, clsst_pt;
       double dist_sq;
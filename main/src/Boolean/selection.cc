@@ -2,10 +2,13 @@
 #include "priv.hh"
 #include "Geo/vector.hh"
 #include "Topology/geom.hh"
+#include "Topology/transaction.hh"
+#include "Topology/visit.hh"
 #include "Utils/error_handling.hh"
+#include "Utils/flat_hash.hh"
 
-#include <set>
 #include <list>
+#include <vector>
 
 namespace Boolean {
 
@@ -22,13 +25,17 @@ struct Selection : public ISelection
     Topo::Wrap<Topo::Type::BODY>& _body_b);
 
 private:
-  void propagate(const Choice _choice, Topo::Wrap<Topo::Type::FACE> _face);
+  void propagate(Topo::Visit& _proc_faces, const Choice _choice,
+    Topo::Wrap<Topo::Type::FACE> _face);
   void apply_selection();
 
-  std::set<Topo::Wrap<Topo::Type::FACE>> proc_faces_;
-  std::set<Topo::Wrap<Topo::Type::FACE>> faces_to_remove_;
-  std::set<Topo::Wrap<Topo::Type::FACE>> faces_to_invert_;
-  std::set<Topo::Wrap<Topo::Type::EDGE>> common_edges_;
+  // Selected by select_overlap_faces. The Visit of the selected faces lives
+  // only in select_faces, so it does not hold the marks of the objects
+  // between the calls.
+  std::vector<Topo::Wrap<Topo::Type::FACE>> overlap_faces_;
+  Utils::FlatHashSet<Topo::Wrap<Topo::Type::FACE>> faces_to_remove_;
+  Utils::FlatHashSet<Topo::Wrap<Topo::Type::FACE>> faces_to_invert_;
+  Utils::FlatHashSet<Topo::Wrap<Topo::Type::EDGE>> common_edges_;
   Operation bool_op_;
 };
 
@@ -109,7 +116,7 @@ void Selection::select_overlap_faces(const OverlapFces& _overlap_faces)
           faces_to_remove_.insert(curr_face);
         else if (choice == INVR)
           faces_to_invert_.insert(curr_face);
-        proc_faces_.insert(curr_face);
+        overlap_faces_.push_back(curr_face);
       }
 
       // Assuming that if face_i and face_j overlaps, it is not possible to have
@@ -129,13 +136,16 @@ void Selection::select_faces(
 {
   Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> edges_a(_body_a);
   Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> edges_b(_body_b);
-  std::set<Topo::Wrap<Topo::Type::EDGE>> edge_sets[2];
-  edge_sets[0].insert(edges_a.begin(), edges_a.end());
-  edge_sets[1].insert(edges_b.begin(), edges_b.end());
-  std::set_intersection(
-    edge_sets[0].begin(), edge_sets[0].end(),
-    edge_sets[1].begin(), edge_sets[1].end(),
-    std::inserter(common_edges_, common_edges_.end()));
+  Utils::FlatHashSet<Topo::Wrap<Topo::Type::EDGE>> edge_set_b;
+  edge_set_b.insert(edges_b.begin(), edges_b.end());
+  for (const auto& edge : edges_a)
+  {
+    if (edge_set_b.count(edge) > 0)
+      common_edges_.insert(edge);
+  }
+  Topo::Visit proc_faces; // Faces already selected.
+  for (const auto& face : overlap_faces_)
+    proc_faces.mark(face.get());
   for (auto& edge : common_edges_)
   {
     struct CoedgeVectors
@@ -171,7 +181,7 @@ void Selection::select_faces(
       coed->geom(seg);
       vcts.coe_dir_ = Topo::coedge_direction(coed);
       vcts.face_norm_ = Topo::face_normal(face);
-      vcts.processed_ = proc_faces_.find(face) != proc_faces_.end();
+      vcts.processed_ = proc_faces.marked(face.get());
       vcts.face_inside_dir_ = vcts.face_norm_ % vcts.coe_dir_;
       vcts.face_ = face;
     }
@@ -188,7 +198,7 @@ void Selection::select_faces(
       for (int j = 0; j < 2; ++j)
       {
         // mark vcts[i][j].face_ using vcts[1-i][0] and vcts[1-i][1]
-        if (proc_faces_.find(coe_vects[i][j].face_) != proc_faces_.end())
+        if (proc_faces.marked(coe_vects[i][j].face_.get()))
           continue;
         FaceClassification fc;
         auto sin_outside_angle = coe_vects[1 - i][0].face_norm_ * coe_vects[1 - i][1].face_inside_dir_;
@@ -216,14 +226,15 @@ void Selection::select_faces(
         }
         Choice choice;
         choice = selection_table[i][size_t(bool_op_)][size_t(fc)];
-        propagate(choice, coe_vects[i][j].face_);
+        propagate(proc_faces, choice, coe_vects[i][j].face_);
       }
     }
   }
   apply_selection();
 }
 
-void Selection::propagate(const Choice _choice, Topo::Wrap<Topo::Type::FACE> _face)
+void Selection::propagate(Topo::Visit& _proc_faces, const Choice _choice,
+  Topo::Wrap<Topo::Type::FACE> _face)
 {
   std::list<Topo::Wrap<Topo::Type::FACE>> face_list;
   face_list.push_back(_face);
@@ -234,17 +245,17 @@ void Selection::propagate(const Choice _choice, Topo::Wrap<Topo::Type::FACE> _fa
       faces_to_invert_.insert(face);
     else if (_choice == REMV)
       faces_to_remove_.insert(face);
-    proc_faces_.insert(face);
+    _proc_faces.mark(face.get());
     face_list.pop_front();
     Topo::Iterator<Topo::Type::FACE, Topo::Type::EDGE> fe_it(face);
     for (auto edge : fe_it)
     {
-      if (common_edges_.find(edge) != common_edges_.end())
+      if (common_edges_.count(edge) > 0)
         continue;
       Topo::Iterator<Topo::Type::EDGE, Topo::Type::FACE> ef_it(edge);
       for (auto face_new : ef_it)
       {
-        if (proc_faces_.find(face_new) != proc_faces_.end())
+        if (_proc_faces.marked(face_new.get()))
           continue;
         face_list.push_front(face_new);
       }
@@ -254,10 +265,10 @@ void Selection::propagate(const Choice _choice, Topo::Wrap<Topo::Type::FACE> _fa
 
 void Selection::apply_selection()
 {
+  Topo::Transaction trans;
   for (auto face : faces_to_remove_)
-  {
-    face->remove();
-  }
+    trans.remove(face.get());
+  trans.commit();
   for (auto face : faces_to_invert_)
   {
     face->reverse();
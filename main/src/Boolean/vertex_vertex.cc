@@ -3,35 +3,76 @@
 
 #include "Geo/vector.hh"
 #include "Geo/minsphere.hh"
+#include "Topology/transaction.hh"
+#include "Utils/flat_hash.hh"
 #include "Utils/statistics.hh"
 
-#include <set>
+#include <algorithm>
 #include <vector>
 
 namespace Boolean {
 
 namespace {
 
-typedef std::set<Topo::Wrap<Topo::Type::VERTEX>> MergeSet;
-typedef std::set<MergeSet> MergeSets;
+typedef std::vector<Topo::Wrap<Topo::Type::VERTEX>> MergeSet;
 
-MergeSets::iterator find(MergeSets& mrg_sets, Topo::Wrap<Topo::Type::VERTEX> _vert)
+// Groups of coincident vertices: a union find on the indices of the
+// vertices, found with a hash map.
+struct MergeSets
 {
-  MergeSet mrg_set;
-  mrg_set.insert(_vert);
-  auto it = mrg_sets.lower_bound(mrg_set);
-  if (it != mrg_sets.end())
-    ++it;
-  while (it != mrg_sets.begin())
+  size_t add(const Topo::Wrap<Topo::Type::VERTEX>& _vert)
   {
-    --it;
-    if (it->find(_vert) != it->end())
-      return it;
-    if (*(it->rbegin()) < _vert)
-      break;
+    auto ins = index_.emplace(_vert, verts_.size());
+    if (ins.second)
+    {
+      verts_.push_back(_vert);
+      parents_.push_back(parents_.size());
+    }
+    return ins.first->second;
   }
-  return mrg_sets.end();
-}
+
+  size_t root(size_t _i)
+  {
+    while (parents_[_i] != _i)
+      _i = parents_[_i] = parents_[parents_[_i]];
+    return _i;
+  }
+
+  void unite(const Topo::Wrap<Topo::Type::VERTEX>& _va,
+    const Topo::Wrap<Topo::Type::VERTEX>& _vb)
+  {
+    auto ra = root(add(_va)), rb = root(add(_vb));
+    if (ra != rb)
+      parents_[std::max(ra, rb)] = std::min(ra, rb);
+  }
+
+  // The groups, each one sorted.
+  std::vector<MergeSet> groups()
+  {
+    std::vector<MergeSet> groups;
+    std::vector<size_t> group_of(verts_.size(), SIZE_MAX);
+    for (size_t i = 0; i < verts_.size(); ++i)
+    {
+      auto& grp = group_of[root(i)];
+      if (grp == SIZE_MAX)
+      {
+        grp = groups.size();
+        groups.emplace_back();
+      }
+      groups[grp].push_back(verts_[i]);
+    }
+    for (auto& group : groups)
+      std::sort(group.begin(), group.end());
+    return groups;
+  }
+
+  bool empty() const { return verts_.empty(); }
+
+private:
+  Utils::FlatHashMap<Topo::Wrap<Topo::Type::VERTEX>, size_t> index_;
+  std::vector<Topo::Wrap<Topo::Type::VERTEX>> verts_;
+  std::vector<size_t> parents_;
+};
 
 }
 
@@ -40,58 +81,25 @@ bool vertices_versus_vertices(
   Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX>& _vert_it_b)
 {
   MergeSets mrg_sets;
-  for (size_t i = 0; i < _vert_it_a.size(); ++i)
+  for (const auto& va : _vert_it_a)
   {
-    for (size_t j = 0; j < _vert_it_b.size(); ++j)
+    Geo::Point pt_a;
+    va->geom(pt_a);
+    for (const auto& vert_b : _vert_it_b)
     {
-      Topo::Wrap<Topo::Type::VERTEX> va = _vert_it_a.get(i);
-      Topo::Wrap<Topo::Type::VERTEX> vb = _vert_it_b.get(j);
-      Geo::Point pt_a, pt_b;
-      va->geom(pt_a);
-      vb->geom(pt_b);
-      auto tol = std::max(va->tolerance(), vb->tolerance());
+      Geo::Point pt_b;
+      vert_b->geom(pt_b);
+      auto tol = std::max(va->tolerance(), vert_b->tolerance());
       if (!Geo::same(pt_a, pt_b, tol))
         continue;
-
-      auto it_a = find(mrg_sets, va);
-      auto it_b = find(mrg_sets, vb);
-      bool found_a = it_a != mrg_sets.end();
-      bool found_b = it_b != mrg_sets.end();
-      if (found_a != found_b)
-      {
-        if (found_b)
-        {
-          it_a = it_b;
-          vb = va;
-        }
-        MergeSet tmp(*it_a);
-        tmp.insert(vb);
-        mrg_sets.erase(it_a);
-        mrg_sets.insert(tmp);
-      }
-      else if (found_a)
-      {
-        if (it_a != it_b)
-        {
-          MergeSet mrg_set(*it_a);
-          mrg_set.insert(it_b->begin(), it_b->end());
-          mrg_sets.erase(it_b);
-          mrg_sets.erase(it_a);
-          mrg_sets.insert(mrg_set);
-        }
-      }
-      else
-      {
-        MergeSet mrg_set;
-        mrg_set.insert(va);
-        mrg_set.insert(vb);
-        mrg_sets.insert(mrg_set);
-      }
+      mrg_sets.unite(va, vert_b);
     }
   }
   if (mrg_sets.empty())
     return false;
-  for (const auto& mrg_set : mrg_sets)
+  // The faces with many merged vertices are edited once.
+  Topo::Transaction trans;
+  for (const auto& mrg_set : mrg_sets.groups())
   {
     std::vector<Geo::Point> pt_to_mrg;
     for (const auto& vert : mrg_set)
@@ -116,9 +124,10 @@ bool vertices_versus_vertices(
     while (++vert_it != mrg_set.end())
     {
       auto vert = *vert_it;
-      vert->replace(vert0.get());
+      trans.replace(vert.get(), vert0.get());
     }
   }
+  trans.commit();
   return true;
 }
 
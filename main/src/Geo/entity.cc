@@ -4,7 +4,7 @@
 #include <pow.hh>
 #include <linear_system.hh>
 #include <Utils/statistics.hh>
-#include "PolygonTriangularization/poly_triang.hh"
+#include "PolygonTriangularization/triang_cache.hh"
 
 #include <vector>
 
@@ -19,28 +19,34 @@ bool check_par(double _u, double _v)
 
 }//namespace
 
-Point evaluate(const Segment& _seg, double _t)
+template <typename ScalarT>
+PointT<ScalarT> evaluate(const SegmentT<ScalarT>& _seg,
+  typename Kernel<ScalarT>::Scalar _t)
 {
   return (1 - _t) * _seg[0] + _t * _seg[1];
 }
 
-Point evaluate(const Triangle& _tri, double _u, double _v)
+template <typename ScalarT>
+PointT<ScalarT> evaluate(const TriangleT<ScalarT>& _tri, ScalarT _u, ScalarT _v)
 {
   return _u * _tri[0] + _v * _tri[1] + (1 - _u - _v) * _tri[2];
 }
 
-bool closest_point(const Segment& _seg, const Point& _pt,
-  Point* _clsst_pt, double* _t, double * _dist_sq)
+template <typename ScalarT>
+bool closest_point(const SegmentT<ScalarT>& _seg, const PointT<ScalarT>& _pt,
+  typename Kernel<ScalarT>::Point* _clsst_pt,
+  typename Kernel<ScalarT>::Scalar* _t,
+  typename Kernel<ScalarT>::Scalar* _dist_sq)
 {
-  Point pt_diff[2] = { _pt - _seg[0], _pt - _seg[1] };
-  double dists_sq[2] = { length_square(pt_diff[0]), length_square(pt_diff[1]) };
+  PointT<ScalarT> pt_diff[2] = { _pt - _seg[0], _pt - _seg[1] };
+  ScalarT dists_sq[2] = { length_square(pt_diff[0]), length_square(pt_diff[1]) };
   size_t orig = dists_sq[0] < dists_sq[1] ? 0 : 1;
   auto p01 = (_seg[1 - orig] - _seg[orig]);
-  double par = pt_diff[orig] * p01;
+  ScalarT par = pt_diff[orig] * p01;
   if (par < 0) // Projection is outside the segment, closest point is the extreme.
   {
     if (_t != nullptr)
-      *_t = double(orig);
+      *_t = ScalarT(orig);
     if (_dist_sq != nullptr)
       *_dist_sq = dists_sq[orig];
     if (_clsst_pt != nullptr)
@@ -66,14 +72,17 @@ bool closest_point(const Segment& _seg, const Point& _pt,
   return true;
 }
 
-bool closest_point(const Segment& _seg_a, const Segment& _seg_b,
-  Point* _clsst_pt, double _t[2], double * _dist_sq)
+template <typename ScalarT>
+bool closest_point(const SegmentT<ScalarT>& _seg_a, const SegmentT<ScalarT>& _seg_b,
+  typename Kernel<ScalarT>::Point* _clsst_pt,
+  typename Kernel<ScalarT>::Scalar* _t,
+  typename Kernel<ScalarT>::Scalar* _dist_sq)
 {
   auto A = _seg_a[0] - _seg_b[0];
   auto b = _seg_a[1] - _seg_a[0];
   auto c = _seg_b[1] - _seg_b[0];
   auto discr = (b * b) * (c * c) - sq(b * c);
-  Utils::StatisticsT<double> len_stats;
+  Utils::StatisticsT<ScalarT> len_stats;
   len_stats.add(length_square(_seg_a[1]));
   len_stats.add(length_square(_seg_a[1]));
   len_stats.add(length_square(_seg_b[0]));
@@ -81,7 +90,7 @@ bool closest_point(const Segment& _seg_a, const Segment& _seg_b,
 
   if (zero(discr, len_stats.max()))
     return false;
-  double t[2];
+  ScalarT t[2];
   t[0] = ((A * c) * (b * c) - (A * b) * (c * c)) / discr;
   t[1] = ((A * c) * (b * b) - (A * b) * (b * c)) / discr;
   if (!check_par(t[0]) || !check_par(t[1]))
@@ -89,7 +98,7 @@ bool closest_point(const Segment& _seg_a, const Segment& _seg_b,
   auto pt_a = evaluate(_seg_a, t[0]);
   auto pt_b = evaluate(_seg_b, t[1]);
   if (_clsst_pt != nullptr)
-    *_clsst_pt = (pt_a + pt_b) / 2.;
+    *_clsst_pt = (pt_a + pt_b) / ScalarT(2);
   if (_dist_sq != nullptr)
     *_dist_sq = length_square(pt_a - pt_b);
   if (_t != nullptr)
@@ -114,6 +123,9 @@ struct PolygonalFace : public IPolygonalFace
 
   virtual Point normal() const;
 
+  void add_triangles(const std::vector<Point>& _poly,
+    const std::array<uint32_t, 3>* _tris, size_t _tri_nmbr);
+
 protected:
   virtual void add_point(const Point& _pt) { pts_.push_back(_pt); }
   virtual void finalize();
@@ -127,16 +139,22 @@ void PolygonalFace::finalize()
 {
   if (pts_.size() < 3)
     return;
-  auto ptg = IPolygonTriangulation::make();
-  ptg->add(pts_);
-  const auto& tris = ptg->triangles();
-  const auto& poly = ptg->polygon();
-  for (const auto& tri : tris)
+  // The same face is often built many times: the cache triangulates it once.
+  const auto tris = ITriangulationCache::global().triangles(pts_);
+  add_triangles(pts_, tris->data(), tris->size());
+}
+
+void PolygonalFace::add_triangles(const std::vector<Point>& _poly,
+  const std::array<uint32_t, 3>* _tris, size_t _tri_nmbr)
+{
+  tris_.reserve(tris_.size() + _tri_nmbr);
+  for (size_t i = 0; i < _tri_nmbr; ++i)
   {
+    const auto& tri = _tris[i];
     tris_.push_back({
-      poly[tri[0]],
-      poly[tri[1]],
-      poly[tri[2]] });
+      _poly[tri[0]],
+      _poly[tri[1]],
+      _poly[tri[2]] });
   }
 }
 
@@ -158,12 +176,29 @@ std::shared_ptr<IPolygonalFace> IPolygonalFace::make_me()
   return std::make_shared<PolygonalFace>();
 }
 
+std::vector<std::shared_ptr<IPolygonalFace>> IPolygonalFace::make_all(
+  const std::vector<std::vector<Point>>& _polys)
+{
+  const auto tris = ITriangulationCache::global().triangles_all(_polys);
+  std::vector<std::shared_ptr<IPolygonalFace>> faces;
+  faces.reserve(_polys.size());
+  for (size_t i = 0; i < _polys.size(); ++i)
+  {
+    auto face = std::make_shared<PolygonalFace>();
+    face->add_triangles(_polys[i], tris[i]->data(), tris[i]->size());
+    faces.push_back(face);
+  }
+  return faces;
+}
+
 // Finds u and v such that the distance between pt and
 // _tri[0] * u + _tri[1] * v + _tri[2] * (1 - u - v)
 // is minimal. u and v must be > 0 and u + v < 1.
 // If the constraints are not satisfied, returns false.
-bool closest_point(const Triangle& _tri, const Point& _pt,
-  Point* _clsst_pt, double * _dist_sq)
+template <typename ScalarT>
+bool closest_point(const TriangleT<ScalarT>& _tri, const PointT<ScalarT>& _pt,
+  typename Kernel<ScalarT>::Point* _clsst_pt,
+  typename Kernel<ScalarT>::Scalar* _dist_sq)
 {
   double A[2][2], B[2];
   auto v0 = _tri[0] - _tri[2];
@@ -182,7 +217,8 @@ bool closest_point(const Triangle& _tri, const Point& _pt,
     return false;
   if (!check_par(uv[0], uv[1]))
     return false;
-  auto clsst_pt = _tri[2] + uv[0] * (_tri[0] - _tri[2]) + uv[1] * (_tri[1] - _tri[2]);
+  auto clsst_pt = _tri[2] + ScalarT(uv[0]) * (_tri[0] - _tri[2]) +
+    ScalarT(uv[1]) * (_tri[1] - _tri[2]);
   if (_clsst_pt != nullptr)
     *_clsst_pt = clsst_pt;
   if (_dist_sq != nullptr)
@@ -214,8 +250,11 @@ bool closest_point(const IPolygonalFace& _face, const Point& _pt,
   return true;
 }
 
-bool closest_point(const Triangle& _tri, const Segment& _seg,
-  Point* _clsst_pt, double * _t, double * _dist_sq)
+template <typename ScalarT>
+bool closest_point(const TriangleT<ScalarT>& _tri, const SegmentT<ScalarT>& _seg,
+  typename Kernel<ScalarT>::Point* _clsst_pt,
+  typename Kernel<ScalarT>::Scalar* _t,
+  typename Kernel<ScalarT>::Scalar* _dist_sq)
 {
   const auto a = _tri[0] - _seg[0];
   const auto b = _tri[1] - _seg[0];
@@ -242,10 +281,10 @@ bool closest_point(const Triangle& _tri, const Segment& _seg,
     return false;
   if (!check_par(uvt[0], uvt[1]) || !check_par(uvt[2]))
     return false;
-  auto pt_seg = evaluate(_seg, uvt[2]);
-  auto pt_tri = evaluate(_tri, uvt[0], uvt[1]);
+  auto pt_seg = evaluate(_seg, ScalarT(uvt[2]));
+  auto pt_tri = evaluate(_tri, ScalarT(uvt[0]), ScalarT(uvt[1]));
   if (_clsst_pt!= nullptr)
-    *_clsst_pt = (pt_seg + pt_tri) / 2.;
+    *_clsst_pt = (pt_seg + pt_tri) / ScalarT(2);
   if (_t != nullptr)
     *_t = uvt[2];
   if (_dist_sq != nullptr)
@@ -281,4 +320,20 @@ bool closest_point(const IPolygonalFace& _face, const Segment& _pt,
   return true;
 }
 
+#define INSTANTIATE_KERNELS(ScalarT) \
+template PointT<ScalarT> evaluate(const SegmentT<ScalarT>&, ScalarT); \
+template bool closest_point(const SegmentT<ScalarT>&, const PointT<ScalarT>&, \
+  PointT<ScalarT>*, ScalarT*, ScalarT*); \
+template bool closest_point(const SegmentT<ScalarT>&, const SegmentT<ScalarT>&, \
+  PointT<ScalarT>*, ScalarT*, ScalarT*); \
+template bool closest_point(const TriangleT<ScalarT>&, const PointT<ScalarT>&, \
+  PointT<ScalarT>*, ScalarT*); \
+template bool closest_point(const TriangleT<ScalarT>&, const SegmentT<ScalarT>&, \
+  PointT<ScalarT>*, ScalarT*, ScalarT*);
+
+INSTANTIATE_KERNELS(float)
+INSTANTIATE_KERNELS(double)
+
+#undef INSTANTIATE_KERNELS
+
 }//namespace Geo
\ No newline at end of file
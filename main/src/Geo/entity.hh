@@ -4,12 +4,17 @@
 
 #include <array>
 #include <memory>
+#include <vector>
 
 namespace Geo {
 
-typedef Vector3 Point;
-typedef std::array<Point, 2> Segment;
-typedef std::array<Point, 3> Triangle;
+template <typename ScalarT> using PointT = VectorT<ScalarT, 3>;
+template <typename ScalarT> using SegmentT = std::array<PointT<ScalarT>, 2>;
+template <typename ScalarT> using TriangleT = std::array<PointT<ScalarT>, 3>;
+
+typedef PointT<double> Point;
+typedef SegmentT<double> Segment;
+typedef TriangleT<double> Triangle;
 
 struct IPolygonalFace
 {
@@ -26,6 +31,9 @@ struct IPolygonalFace
     poly_face->finalize();
     return poly_face;
   }
+  // Makes a face for every polygon, triangulating them in parallel.
+  static std::vector<std::shared_ptr<IPolygonalFace>> make_all(
+    const std::vector<std::vector<Point>>& _polys);
 protected:
   virtual void add_point(const Point& _pt) = 0;
   virtual void finalize() = 0;
@@ -34,11 +42,17 @@ private:
 };
 
 
-Point evaluate(const Segment& _seg, double _t);
+// The kernels on segments and triangles are instantiated for float and
+// double.
+template <typename ScalarT>
+PointT<ScalarT> evaluate(const SegmentT<ScalarT>& _seg,
+  typename Kernel<ScalarT>::Scalar _t);
 
-bool closest_point(const Segment& _seg, const Point& _pt,
-  Point* _clsst_pt = nullptr, double* _t = nullptr, 
-  double * _dist_sq = nullptr);
+template <typename ScalarT>
+bool closest_point(const SegmentT<ScalarT>& _seg, const PointT<ScalarT>& _pt,
+  typename Kernel<ScalarT>::Point* _clsst_pt = nullptr,
+  typename Kernel<ScalarT>::Scalar* _t = nullptr,
+  typename Kernel<ScalarT>::Scalar* _dist_sq = nullptr);
 
 /*! Finds the internal points at minimum distance between two segments.
     Returns false 
@@ -46,14 +60,19 @@ bool closest_point(const Segment& _seg, const Point& _pt,
     if the minimum distance point between the two segment is on an end of 
     at least one the two segments.
 */
-bool closest_point(const Segment& _seg_a, const Segment& _seg_b,
-  Point* _clsst_pt = nullptr, double _t[2] = nullptr, double * _dist = nullptr);
+template <typename ScalarT>
+bool closest_point(const SegmentT<ScalarT>& _seg_a, const SegmentT<ScalarT>& _seg_b,
+  typename Kernel<ScalarT>::Point* _clsst_pt = nullptr,
+  typename Kernel<ScalarT>::Scalar* _t = nullptr,
+  typename Kernel<ScalarT>::Scalar* _dist = nullptr);
 
 /*! Finds the internal point of a triangle closest to a point, ad its distance.
 The closest point is returned only if it is strictly inside the triangle.
 */
-bool closest_point(const Triangle& _tri, const Point& _pt,
-  Point* _clsst_pt, double * _dist_sq);
+template <typename ScalarT>
+bool closest_point(const TriangleT<ScalarT>& _tri, const PointT<ScalarT>& _pt,
+  typename Kernel<ScalarT>::Point* _clsst_pt,
+  typename Kernel<ScalarT>::Scalar* _dist_sq);
 
 /*! Finds the internal point of a PolygonalFace closest to a point, ad its distance.
 The closest point is returned only if it is strictly inside the PolygonalFace.
@@ -63,8 +82,11 @@ the triangles used to create the face.
 bool closest_point(const IPolygonalFace& _face, const Point& _pt,
   Point* _clsst_pt = nullptr, double * _dist_sq = nullptr);
 
-bool closest_point(const Triangle& _tri, const Segment& _seg,
-  Point* _clsst_pt = nullptr, double * _t = nullptr, double * _dist_sq = nullptr);
+template <typename ScalarT>
+bool closest_point(const TriangleT<ScalarT>& _tri, const SegmentT<ScalarT>& _seg,
+  typename Kernel<ScalarT>::Point* _clsst_pt = nullptr,
+  typename Kernel<ScalarT>::Scalar* _t = nullptr,
+  typename Kernel<ScalarT>::Scalar* _dist_sq = nullptr);
 
 bool closest_point(const IPolygonalFace& _face, const Segment& _seg,
   Point* _clsst_pt = nullptr, double * _t = nullptr, double * _dist_sq = nullptr);
@@ -4,6 +4,7 @@
 #include "plane_fitting.hh"
 #include "iterate.hh"
 #include <Utils/error_handling.hh>
+#include "Eigen/Eigenvalues"
 #include "Eigen/SVD"
 #include <vector>
 
@@ -71,4 +72,35 @@ std::shared_ptr<IPlaneFit> IPlaneFit::make()
   return std::make_shared<PlaneFit>();
 }
 
+template <typename ScalarT>
+bool fit_plane(const VectorT<ScalarT, 3>* _pts, size_t _size,
+  Vector3& _center, Vector3& _normal)
+{
+  if (_size == 0)
+    return false;
+  _center = { 0, 0, 0 };
+  for (size_t i = 0; i < _size; ++i)
+    iterate_forw<3>::eval([&_center, &_pts, i](int _j) { _center[_j] += _pts[i][_j]; });
+  _center /= double(_size);
+
+  Eigen::Matrix3d covar = Eigen::Matrix3d::Zero();
+  for (size_t i = 0; i < _size; ++i)
+  {
+    const Eigen::Vector3d d(_pts[i][0] - _center[0], _pts[i][1] - _center[1],
+      _pts[i][2] - _center[2]);
+    covar += d * d.transpose();
+  }
+  // Eigenvalues are in increasing order, the normal is the direction of
+  // the smallest spread.
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eig(covar);
+  iterate_forw<3>::eval([&_normal, &eig](int _i)
+  {
+    _normal[_i] = eig.eigenvectors()(_i, 0);
+  });
+  return true;
+}
+
+template bool fit_plane(const Vector3*, size_t, Vector3&, Vector3&);
+template bool fit_plane(const Vector3f*, size_t, Vector3&, Vector3&);
+
 }//namespace Geo
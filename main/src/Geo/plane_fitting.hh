@@ -30,4 +30,12 @@ struct IPlaneFit
   static std::shared_ptr<IPlaneFit> make();
 };
 
+/*! Same as IPlaneFit for the points in [_pts, _pts + _size), but it uses
+    the eigenvectors of the 3x3 covariance matrix and does not allocate
+    memory. Float and double points, the plane is computed in double.
+*/
+template <typename ScalarT>
+bool fit_plane(const VectorT<ScalarT, 3>* _pts, size_t _size,
+  Vector3& _center, Vector3& _normal);
+
 }//namespace Geo
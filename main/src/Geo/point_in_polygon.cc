@@ -10,22 +10,24 @@ namespace Geo
 namespace PointInPolygon
 {
 
+template <typename ScalarT>
 Classification classify(
-  const std::vector<Geo::Vector3>& _poly,
-  const Geo::Vector3& _pt,
-  const Geo::Vector3* _norm)
+  const std::vector<Geo::VectorT<ScalarT, 3>>& _poly,
+  const Geo::VectorT<ScalarT, 3>& _pt,
+  const typename Geo::Kernel<ScalarT>::Point* _norm)
 {
-  Utils::StatisticsT<double> tol_max;
+  Utils::StatisticsT<ScalarT> tol_max;
   for (const auto& pt : _poly)
     tol_max.add(Geo::epsilon(pt));
   return classify(_poly, _pt, tol_max.max() * 10, _norm);
 }
 
+template <typename ScalarT>
 Classification classify(
-  const std::vector<Geo::Vector3>& _poly,
-  const Geo::Vector3& _pt,
-  const double& _tol,
-  const Geo::Vector3* _norm)
+  const std::vector<Geo::VectorT<ScalarT, 3>>& _poly,
+  const Geo::VectorT<ScalarT, 3>& _pt,
+  const typename Geo::Kernel<ScalarT>::Scalar& _tol,
+  const typename Geo::Kernel<ScalarT>::Point* _norm)
 {
   const auto tol_sq = Geo::sq(_tol);
   for (const auto& poly_pt : _poly)
@@ -33,26 +35,24 @@ Classification classify(
     if (length_square(poly_pt - _pt) < tol_sq)
       return On;
   }
-  Vector3 norm;
+  Geo::VectorT<ScalarT, 3> norm;
   if (_norm != nullptr)
     norm = *_norm;
   else
   {
-    auto pl_fit = IPlaneFit::make();
-    pl_fit->init(_poly.size());
-    for (const auto pt : _poly)
-      pl_fit->add_point(pt);
-    Vector3 centr;
-    pl_fit->compute(centr, norm);
+    Vector3 centr, norm_d;
+    fit_plane(_poly.data(), _poly.size(), centr, norm_d);
+    for (size_t i = 0; i < 3; ++i)
+      norm[i] = ScalarT(norm_d[i]);
   }
   auto v0 = _poly.back() - _pt;
-  double angl = 0;
+  ScalarT angl = 0;
   for (const auto& poly_pt : _poly)
   {
     auto v1 = poly_pt - _pt;
     if (v0 * v1 < 0)
     {
-      double h = 0.25 * length_square(v0 % v1) / 
+      ScalarT h = ScalarT(0.25) * length_square(v0 % v1) /
         length_square(v0 - v1);
       if (h < tol_sq)
         return On;
@@ -64,6 +64,17 @@ Classification classify(
   return std::fabs(angl) > M_PI ? Inside : Outside;
 }
 
+#define INSTANTIATE_CLASSIFY(ScalarT) \
+template Classification classify(const std::vector<VectorT<ScalarT, 3>>&, \
+  const VectorT<ScalarT, 3>&, const VectorT<ScalarT, 3>*); \
+template Classification classify(const std::vector<VectorT<ScalarT, 3>>&, \
+  const VectorT<ScalarT, 3>&, const ScalarT&, const VectorT<ScalarT, 3>*);
+
+INSTANTIATE_CLASSIFY(float)
+INSTANTIATE_CLASSIFY(double)
+
+#undef INSTANTIATE_CLASSIFY
+
 }//namespace PointInPolygon
 
 }//namespace Geo
\ No newline at end of file
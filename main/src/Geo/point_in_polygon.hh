@@ -8,16 +8,21 @@ namespace Geo
 namespace PointInPolygon
 {
 enum Classification {Inside, Outside, On};
+
+// Instantiated for float and double polygons. The tolerance and the normal
+// have the scalar type of the polygon.
+template <typename ScalarT>
 Classification classify(
-  const std::vector<Geo::Vector3>& _poly,
-  const Geo::Vector3& _pt,
-  const double& _tol,
-  const Geo::Vector3* _norm = nullptr);
+  const std::vector<Geo::VectorT<ScalarT, 3>>& _poly,
+  const Geo::VectorT<ScalarT, 3>& _pt,
+  const typename Geo::Kernel<ScalarT>::Scalar& _tol,
+  const typename Geo::Kernel<ScalarT>::Point* _norm = nullptr);
 
+template <typename ScalarT>
 Classification classify(
-  const std::vector<Geo::Vector3>& _poly,
-  const Geo::Vector3& _pt,
-  const Geo::Vector3* _norm = nullptr);
+  const std::vector<Geo::VectorT<ScalarT, 3>>& _poly,
+  const Geo::VectorT<ScalarT, 3>& _pt,
+  const typename Geo::Kernel<ScalarT>::Point* _norm = nullptr);
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "predicates.hh"
+
+#include <cmath>
+
+namespace Geo
+{
+
+namespace {
+
+// a + b = x + y exactly, |y| <= ulp(x) / 2.
+inline void two_sum(const double _a, const double _b, double& _x, double& _y)
+{
+  _x = _a + _b;
+  const auto b_virt = _x - _a;
+  const auto a_virt = _x - b_virt;
+  _y = (_a - a_virt) + (_b - b_virt);
+}
+
+// a * b = x + y exactly.
+inline void two_product(const double _a, const double _b, double& _x, double& _y)
+{
+  _x = _a * _b;
+  _y = std::fma(_a, _b, -_x);
+}
+
+// Exact sum of doubles as a nonoverlapping expansion, components sorted by
+// increasing magnitude, zeros removed. The sign is the one of the last one.
+struct Expansion
+{
+  void add(double _b)
+  {
+    size_t k = 0;
+    for (size_t i = 0; i < size_; ++i)
+    {
+      double err;
+      two_sum(_b, comps_[i], _b, err);
+      if (err != 0)
+        comps_[k++] = err;
+    }
+    if (_b != 0)
+      comps_[k++] = _b;
+    size_ = k;
+  }
+
+  double estimate() const { return size_ == 0 ? 0 : comps_[size_ - 1]; }
+
+private:
+  static const size_t CAPACITY = 1024;
+  double comps_[CAPACITY];
+  size_t size_ = 0;
+};
+
+// a - b = hi + lo exactly.
+struct Diff
+{
+  Diff(const double _a, const double _b)
+  {
+    two_sum(_a, -_b, hi_, lo_);
+  }
+  double hi_, lo_;
+};
+
+// Adds _sign * product of the factors (at most 4) to _sum.
+void add_product(Expansion& _sum, const Diff* const* _facts, size_t _nmbr,
+  const double _sign)
+{
+  for (size_t mask = 0; mask < (size_t(1) << _nmbr); ++mask)
+  {
+    double terms[8] = { _sign * (mask & 1 ? _facts[0]->lo_ : _facts[0]->hi_) };
+    size_t term_nmbr = terms[0] == 0 ? 0 : 1;
+    for (size_t i = 1; i < _nmbr && term_nmbr > 0; ++i)
+    {
+      const auto f = (mask >> i) & 1 ? _facts[i]->lo_ : _facts[i]->hi_;
+      if (f == 0)
+        term_nmbr = 0;
+      for (size_t j = term_nmbr; j-- > 0;)
+        two_product(terms[j], f, terms[2 * j + 1], terms[2 * j]);
+      term_nmbr *= 2;
+    }
+    for (size_t j = 0; j < term_nmbr; ++j)
+      _sum.add(terms[j]);
+  }
+}
+
+}//namespace
+
+double orient2d_exact(const Vector<2>& _a, const Vector<2>& _b, const Vector<2>& _c)
+{
+  const Diff acx(_a[0], _c[0]), acy(_a[1], _c[1]);
+  const Diff bcx(_b[0], _c[0]), bcy(_b[1], _c[1]);
+  const Diff* left[] = { &acx, &bcy };
+  const Diff* right[] = { &acy, &bcx };
+  Expansion det;
+  add_product(det, left, 2, 1);
+  add_product(det, right, 2, -1);
+  return det.estimate();
+}
+
+double incircle_exact(const Vector<2>& _a, const Vector<2>& _b,
+  const Vector<2>& _c, const Vector<2>& _d)
+{
+  const Diff dx[3] = { { _a[0], _d[0] }, { _b[0], _d[0] }, { _c[0], _d[0] } };
+  const Diff dy[3] = { { _a[1], _d[1] }, { _b[1], _d[1] }, { _c[1], _d[1] } };
+  // Sum on the rows i of (dx_i^2 + dy_i^2) * (dx_j * dy_k - dy_j * dx_k).
+  Expansion det;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    const auto j = (i + 1) % 3, k = (i + 2) % 3;
+    for (const auto lift : { &dx[i], &dy[i] })
+    {
+      const Diff* plus[] = { lift, lift, &dx[j], &dy[k] };
+      const Diff* minus[] = { lift, lift, &dy[j], &dx[k] };
+      add_product(det, plus, 4, 1);
+      add_product(det, minus, 4, -1);
+    }
+  }
+  return det.estimate();
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "vector.hh"
+
+#include <cmath>
+
+// Orientation and incircle predicates with a floating point filter
+// (Shewchuk, Adaptive Precision Floating-Point Arithmetic and Fast Robust
+// Geometric Predicates). When the double result is too close to zero to
+// trust its sign, it is recomputed exactly. The sign is always correct,
+// the value is an approximation.
+
+namespace Geo
+{
+
+double orient2d_exact(const Vector<2>& _a, const Vector<2>& _b, const Vector<2>& _c);
+
+double incircle_exact(const Vector<2>& _a, const Vector<2>& _b,
+  const Vector<2>& _c, const Vector<2>& _d);
+
+// Twice the signed area of the triangle, positive if it is counterclockwise.
+inline double orient2d(const Vector<2>& _a, const Vector<2>& _b, const Vector<2>& _c)
+{
+  const double ERR_BOUND = 3.3306690738754716e-16; // (3 + 16 eps) eps
+  const auto det_left = (_a[0] - _c[0]) * (_b[1] - _c[1]);
+  const auto det_right = (_a[1] - _c[1]) * (_b[0] - _c[0]);
+  const auto det = det_left - det_right;
+  if ((det_left > 0) == (det_right > 0) && det_left != 0 && det_right != 0)
+  {
+    const auto det_sum = std::fabs(det_left + det_right);
+    if (std::fabs(det) >= ERR_BOUND * det_sum)
+      return det;
+    return orient2d_exact(_a, _b, _c);
+  }
+  return det; // The terms have opposite signs or one is zero: no cancellation.
+}
+
+// Positive if _d is inside the circle through the counterclockwise triangle
+// _a, _b, _c, negative if outside, zero if on it.
+inline double incircle(const Vector<2>& _a, const Vector<2>& _b,
+  const Vector<2>& _c, const Vector<2>& _d)
+{
+  const double ERR_BOUND = 1.1102230246251577e-15; // (10 + 96 eps) eps
+  const auto adx = _a[0] - _d[0], ady = _a[1] - _d[1];
+  const auto bdx = _b[0] - _d[0], bdy = _b[1] - _d[1];
+  const auto cdx = _c[0] - _d[0], cdy = _c[1] - _d[1];
+  const auto bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  const auto cdxady = cdx * ady, adxcdy = adx * cdy;
+  const auto adxbdy = adx * bdy, bdxady = bdx * ady;
+  const auto alift = adx * adx + ady * ady;
+  const auto blift = bdx * bdx + bdy * bdy;
+  const auto clift = cdx * cdx + cdy * cdy;
+  const auto det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) +
+    clift * (adxbdy - bdxady);
+  const auto permanent =
+    (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * alift +
+    (std::fabs(cdxady) + std::fabs(adxcdy)) * blift +
+    (std::fabs(adxbdy) + std::fabs(bdxady)) * clift;
+  if (std::fabs(det) > ERR_BOUND * permanent)
+    return det;
+  return incircle_exact(_a, _b, _c, _d);
+}
+
+}
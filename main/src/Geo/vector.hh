@@ -147,7 +147,17 @@ bool decompose(const std::array<ValT, N>& _w,
   const std::array<ValT, N>& _a, const std::array<ValT, N>& _b,
   ValT& _u, ValT& _v);
 
-template <size_t dimT> using Vector = std::array<double, dimT>;
+template <typename ScalarT, size_t dimT> using VectorT = std::array<ScalarT, dimT>;
+template <size_t dimT> using Vector = VectorT<double, dimT>;
 typedef Vector<3> Vector3;
+typedef VectorT<float, 3> Vector3f;
+
+// Types of the output arguments of the kernels. They are not used to deduce
+// the scalar type, that comes from the input ones, so they can be nullptr.
+template <typename ScalarT> struct Kernel
+{
+  typedef ScalarT Scalar;
+  typedef VectorT<ScalarT, 3> Point;
+};
 
 }//namespace Geo
@@ -4,7 +4,11 @@
 
 namespace Import {
 
-Topo::Wrap<Topo::Type::BODY> load_obj(const char* _flnm);
+// With _compact the points and the faces are put in Topo::spatial_order
+// before the body is made, as Topo::compact does.
+Topo::Wrap<Topo::Type::BODY> load_obj(const char* _flnm, bool _compact = false);
+// As load_obj, in a compact read-only body (Topo::make_mesh_body).
+Topo::Wrap<Topo::Type::BODY> load_obj_mesh(const char* _flnm, bool _compact = false);
 bool save_obj(const char* _flnm, Topo::Wrap<Topo::Type::BODY>);
 
 }//namespace Import
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <Geo/vector.hh>
 
 #include <Topology/impl.hh>
+#include <Topology/mesh.hh>
 
 
 #include <fstream>
@@ -10,14 +11,16 @@
 
 namespace Import {
 
-Topo::Wrap<Topo::Type::BODY> load_obj(const char* _flnm)
+namespace {
+
+// Calls _add_point(pt) for each point and _add_face(inds) for each face,
+// with the 0 based indices of its points.
+template <class AddPointT, class AddFaceT>
+void read_obj(const char* _flnm, AddPointT _add_point, AddFaceT _add_face)
 {
-  Topo::Wrap<Topo::Type::BODY> new_body;
   std::ifstream fstr(_flnm);
   std::string line;
-  std::vector<Topo::Wrap<Topo::Type::VERTEX>> verts;
-
-  new_body.make<Topo::EE<Topo::Type::BODY>>();
+  std::vector<size_t> inds;
   while (std::getline(fstr, line))
   {
     if (line.size() < 3 || line[1] != ' ')
@@ -28,21 +31,15 @@ Topo::Wrap<Topo::Type::BODY> load_obj(const char* _flnm)
       Geo::Point pt;
       for (auto& coord : pt)
         buf >> coord;
-      verts.emplace_back();
-      auto& new_vert = verts.back();
-      new_vert.make<Topo::EE<Topo::Type::VERTEX>>();
-      new_vert->set_geom(pt);
-      new_vert->set_tolerance(Geo::epsilon(pt));
+      _add_point(pt);
     }
     else if (line[0] == 'f')
     {
-      Topo::Wrap<Topo::Type::FACE> face;
-      face.make<Topo::EE<Topo::Type::FACE>>();
-      new_body->insert_child(face.get());
+      inds.clear();
       int vert_idx;
       while (buf >> vert_idx)
       {
-        face->insert_child(verts[vert_idx-1].get());
+        inds.push_back(vert_idx - 1);
         char c;
         while (buf >> c && c == '/')
         {
@@ -52,9 +49,61 @@ Topo::Wrap<Topo::Type::BODY> load_obj(const char* _flnm)
         }
         buf.putback(c);
       }
+      _add_face(inds);
     }
   }
+}
+
+}//namespace
+
+Topo::Wrap<Topo::Type::BODY> load_obj(const char* _flnm, bool _compact)
+{
+  if (_compact)
+    return Topo::expand_mesh_body(load_obj_mesh(_flnm, true));
+  Topo::Wrap<Topo::Type::BODY> new_body;
+  std::vector<Topo::Wrap<Topo::Type::VERTEX>> verts;
+
+  new_body.make<Topo::EE<Topo::Type::BODY>>();
+  read_obj(_flnm,
+    [&verts](const Geo::Point& _pt)
+  {
+    verts.emplace_back();
+    auto& new_vert = verts.back();
+    new_vert.make<Topo::EE<Topo::Type::VERTEX>>();
+    new_vert->set_geom(_pt);
+    new_vert->set_tolerance(Geo::epsilon(_pt));
+  },
+    [&verts, &new_body](const std::vector<size_t>& _inds)
+  {
+    Topo::Wrap<Topo::Type::FACE> face;
+    face.make<Topo::EE<Topo::Type::FACE>>();
+    new_body->insert_child(face.get());
+    for (auto ind : _inds)
+      face->insert_child(verts[ind].get());
+  });
   return new_body;
 }
 
-}//namespace Import
\ No newline at end of file
+Topo::Wrap<Topo::Type::BODY> load_obj_mesh(const char* _flnm, bool _compact)
+{
+  std::vector<Geo::Point> pts;
+  std::vector<double> tols;
+  std::vector<uint32_t> face_offs(1, 0), face_verts;
+  read_obj(_flnm,
+    [&pts, &tols](const Geo::Point& _pt)
+  {
+    pts.push_back(_pt);
+    tols.push_back(Geo::epsilon(_pt));
+  },
+    [&face_offs, &face_verts](const std::vector<size_t>& _inds)
+  {
+    face_verts.insert(face_verts.end(), _inds.begin(), _inds.end());
+    face_offs.push_back(uint32_t(face_verts.size()));
+  });
+  if (_compact)
+    Topo::spatial_order(pts, tols, face_offs, face_verts);
+  return Topo::make_mesh_body(std::move(pts), std::move(tols),
+    std::move(face_offs), std::move(face_verts));
+}
+
+}//namespace Import
@@ -0,0 +1,258 @@
+#include "priv.hh"
+#include "Utils/error_handling.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace PolyTriang {
+
+namespace {
+
+// Edges of the loop (identified by their first point) in a segment tree on
+// horizontal rows, to find quickly the ones crossed by a horizontal ray: an
+// edge is in the O(log n) nodes covering its rows, and the edges crossing
+// a row are in the nodes from its leaf to the root. The first points of
+// the edges are also listed in their row. An edge whose end changes is
+// added again, so old entries can be stale: the geometry is always taken
+// from the ring. The nodes and rows are kept between runs.
+struct EdgeRows
+{
+  EdgeRows(const std::vector<Point2>& _pts, const Ring& _ring,
+    std::vector<std::vector<size_t>>& _nodes,
+    std::vector<std::vector<size_t>>& _rows,
+    size_t _row_nmbr, double _y_min, double _y_max)
+    : pts_(_pts), ring_(_ring), nodes_(_nodes), rows_(_rows),
+    row_nmbr_(std::max<size_t>(_row_nmbr, 1)), y_min_(_y_min)
+  {
+    leaf_nmbr_ = 1;
+    while (leaf_nmbr_ < row_nmbr_)
+      leaf_nmbr_ *= 2;
+    if (nodes_.size() < 2 * leaf_nmbr_)
+      nodes_.resize(2 * leaf_nmbr_);
+    for (size_t i = 1; i < 2 * leaf_nmbr_; ++i)
+      nodes_[i].clear();
+    if (rows_.size() < row_nmbr_)
+      rows_.resize(row_nmbr_);
+    for (size_t r = 0; r < row_nmbr_; ++r)
+      rows_[r].clear();
+    const auto h = _y_max - _y_min;
+    scale_ = h > 0 ? (row_nmbr_ - 1) / h : 0;
+  }
+
+  size_t row(double _y) const
+  {
+    const auto r = (_y - y_min_) * scale_;
+    if (r <= 0)
+      return 0;
+    return std::min(static_cast<size_t>(r), row_nmbr_ - 1);
+  }
+
+  void add(size_t _e)
+  {
+    auto r0 = row(pts_[_e][1]), r1 = row(pts_[ring_.next_[_e]][1]);
+    rows_[r0].push_back(_e);
+    if (r1 < r0)
+      std::swap(r0, r1);
+    for (auto l = r0 + leaf_nmbr_, r = r1 + leaf_nmbr_ + 1; l < r; l /= 2, r /= 2)
+    {
+      if (l & 1)
+        nodes_[l++].push_back(_e);
+      if (r & 1)
+        nodes_[--r].push_back(_e);
+    }
+  }
+
+  // The edges crossing _row are in the nodes leaf(_row), leaf(_row) / 2,
+  // ... down to 1.
+  size_t leaf(size_t _row) const { return _row + leaf_nmbr_; }
+  const std::vector<size_t>& node(size_t _i) const { return nodes_[_i]; }
+
+  // The first points of the edges in _row.
+  const std::vector<size_t>& points(size_t _row) const { return rows_[_row]; }
+
+private:
+  const std::vector<Point2>& pts_;
+  const Ring& ring_;
+  std::vector<std::vector<size_t>>& nodes_;
+  std::vector<std::vector<size_t>>& rows_;
+  size_t row_nmbr_;
+  size_t leaf_nmbr_;
+  double y_min_;
+  double scale_;
+};
+
+bool right_of(const Point2& _a, const Point2& _b)
+{
+  return _a[0] > _b[0] || (_a[0] == _b[0] && _a[1] > _b[1]);
+}
+
+// True if _pt is inside or on the boundary of the triangle.
+bool in_triangle(const Point2& _a, const Point2& _b, const Point2& _c,
+  const Point2& _pt)
+{
+  const auto o0 = orient(_a, _b, _pt);
+  const auto o1 = orient(_b, _c, _pt);
+  const auto o2 = orient(_c, _a, _pt);
+  return (o0 >= 0 && o1 >= 0 && o2 >= 0) || (o0 <= 0 && o1 <= 0 && o2 <= 0);
+}
+
+// True if the segment from _v to _pt leaves _v inside the polygon.
+bool locally_inside(const std::vector<Point2>& _pts, const Ring& _ring,
+  size_t _v, const Point2& _pt)
+{
+  const auto& prev = _pts[_ring.prev_[_v]];
+  const auto& next = _pts[_ring.next_[_v]];
+  const auto& pt = _pts[_v];
+  if (orient(prev, pt, next) >= 0)
+    return orient(pt, next, _pt) >= 0 && orient(prev, pt, _pt) >= 0;
+  return orient(pt, next, _pt) >= 0 || orient(prev, pt, _pt) >= 0;
+}
+
+// Finds a point of the loop visible from the point _m of an island, all
+// the islands not bridged yet being on the left of _m (D. Eberly,
+// Triangulation by ear clipping).
+size_t find_bridge(const std::vector<Point2>& _pts, const Ring& _ring,
+  const EdgeRows& _rows, size_t _m)
+{
+  const auto& m = _pts[_m];
+  // Nearest edge crossed by the ray from _m towards +x. The inside is on
+  // the left of the edges, so only the upward ones can be hit.
+  auto qx = std::numeric_limits<double>::max();
+  size_t cand = Utils::INVALID_INDEX;
+  for (auto node = _rows.leaf(_rows.row(m[1])); node > 0; node /= 2)
+  {
+    for (auto e : _rows.node(node))
+    {
+      const auto& a = _pts[e];
+      if (a == m)
+        return e;
+      const auto& b = _pts[_ring.next_[e]];
+      if (a[1] > m[1] || b[1] < m[1] || a[1] == b[1])
+        continue;
+      const auto x = a[0] + (m[1] - a[1]) * (b[0] - a[0]) / (b[1] - a[1]);
+      if (x < m[0] || x >= qx)
+        continue;
+      qx = x;
+      cand = a[0] > b[0] ? e : _ring.next_[e];
+      if (x == m[0])
+        return cand;
+    }
+  }
+  THROW_IF(cand == Utils::INVALID_INDEX, "Island outside of the polygon.");
+
+  // Points inside the triangle (m, ray hit, candidate) can hide the
+  // candidate: take the one with the smallest angle with the ray.
+  const Point2 hit = { qx, m[1] };
+  const auto p = _pts[cand];
+  auto tan_min = std::numeric_limits<double>::max();
+  auto r0 = _rows.row(std::min(m[1], p[1])), r1 = _rows.row(std::max(m[1], p[1]));
+  for (auto r = r0; r <= r1; ++r)
+  {
+    for (auto v : _rows.points(r))
+    {
+      const auto& pt = _pts[v];
+      if (pt[0] < m[0] || pt[0] > p[0] || pt[0] == m[0] ||
+        !in_triangle(m, hit, p, pt))
+      {
+        continue;
+      }
+      const auto tan = std::fabs(m[1] - pt[1]) / (pt[0] - m[0]);
+      if (locally_inside(_pts, _ring, v, m) &&
+        (tan < tan_min || (tan == tan_min && pt[0] < _pts[cand][0])))
+      {
+        cand = v;
+        tan_min = tan;
+      }
+    }
+  }
+  return cand;
+}
+
+size_t add_copy(std::vector<Point2>& _pts, Ring& _ring,
+  std::vector<size_t>& _orig, size_t _v)
+{
+  _pts.push_back(_pts[_v]);
+  _ring.prev_.push_back(Utils::INVALID_INDEX);
+  _ring.next_.push_back(Utils::INVALID_INDEX);
+  _orig.push_back(_orig[_v]);
+  return _pts.size() - 1;
+}
+
+}//namespace
+
+size_t Bridge::operator()(std::vector<Point2>& _pts, Ring& _ring,
+  const std::vector<size_t>& _loop_ends, const size_t _outer,
+  std::vector<size_t>& _orig)
+{
+  _orig.resize(_pts.size());
+  std::iota(_orig.begin(), _orig.end(), 0);
+
+  // Start of every island from its rightmost point.
+  size_t start = Utils::INVALID_INDEX;
+  islands_.clear();
+  auto y_min = std::numeric_limits<double>::max();
+  auto y_max = -y_min;
+  size_t used_nmbr = 0;
+  size_t beg = 0;
+  for (size_t l = 0; l < _loop_ends.size(); beg = _loop_ends[l++])
+  {
+    size_t right = Utils::INVALID_INDEX;
+    for (auto i = beg; i < _loop_ends[l]; ++i)
+    {
+      if (!_ring.used(i))
+        continue;
+      ++used_nmbr;
+      y_min = std::min(y_min, _pts[i][1]);
+      y_max = std::max(y_max, _pts[i][1]);
+      if (right == Utils::INVALID_INDEX || right_of(_pts[i], _pts[right]))
+        right = i;
+    }
+    if (right == Utils::INVALID_INDEX)
+      continue;
+    if (l == _outer)
+      start = right;
+    else
+      islands_.push_back(right);
+  }
+  if (start == Utils::INVALID_INDEX || islands_.empty())
+    return start;
+
+  // Islands are bridged from right to left, so the ray from the rightmost
+  // point of the current one cannot hit one not yet joined.
+  std::sort(islands_.begin(), islands_.end(), [&_pts](size_t _a, size_t _b)
+  {
+    return right_of(_pts[_a], _pts[_b]);
+  });
+
+  EdgeRows rows(_pts, _ring, nodes_, rows_, used_nmbr, y_min, y_max);
+  auto v = start;
+  do
+  {
+    rows.add(v);
+    v = _ring.next_[v];
+  } while (v != start);
+
+  for (auto m : islands_)
+  {
+    auto p = find_bridge(_pts, _ring, rows, m);
+    // p -> m -> ... island ... -> m_prev -> m2 -> p2 -> p_next
+    auto p2 = add_copy(_pts, _ring, _orig, p);
+    auto m2 = add_copy(_pts, _ring, _orig, m);
+    const auto p_next = _ring.next_[p], m_prev = _ring.prev_[m];
+    _ring.next_[p] = m;
+    _ring.prev_[m] = p;
+    _ring.next_[m_prev] = m2;
+    _ring.prev_[m2] = m_prev;
+    _ring.next_[m2] = p2;
+    _ring.prev_[p2] = m2;
+    _ring.next_[p2] = p_next;
+    _ring.prev_[p_next] = p2;
+    for (v = p; v != p_next; v = _ring.next_[v])
+      rows.add(v);
+  }
+  return start;
+}
+
+}//namespace PolyTriang
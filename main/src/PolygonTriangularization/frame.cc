@@ -0,0 +1,71 @@
+#include "priv.hh"
+#include "Geo/plane_fitting.hh"
+
+#include <cmath>
+
+namespace PolyTriang {
+
+template <typename ScalarT>
+void Frame::init(const std::vector<Geo::VectorT<ScalarT, 3>>& _pts)
+{
+  Geo::fit_plane(_pts.data(), _pts.size(), centr_, norm_);
+
+  // The first axis is orthogonal to the normal and to the coordinate axis
+  // closest to be orthogonal to the normal.
+  size_t min_comp = 0;
+  for (size_t i = 1; i < 3; ++i)
+  {
+    if (std::fabs(norm_[i]) < std::fabs(norm_[min_comp]))
+      min_comp = i;
+  }
+  Geo::Vector3 axis = { 0, 0, 0 };
+  axis[min_comp] = 1;
+  axes_[0] = norm_ % axis;
+  axes_[0] /= Geo::length(axes_[0]);
+  axes_[1] = norm_ % axes_[0];
+}
+
+template <typename ScalarT>
+void Frame::project(const std::vector<Geo::VectorT<ScalarT, 3>>& _pts,
+  std::vector<Point2>& _pts_2d) const
+{
+  _pts_2d.resize(_pts.size());
+  for (size_t i = 0; i < _pts.size(); ++i)
+    _pts_2d[i] = project(_pts[i]);
+}
+
+template void Frame::init(const std::vector<Geo::Vector3f>&);
+template void Frame::init(const std::vector<Geo::Vector3>&);
+template void Frame::project(const std::vector<Geo::Vector3f>&,
+  std::vector<Point2>&) const;
+template void Frame::project(const std::vector<Geo::Vector3>&,
+  std::vector<Point2>&) const;
+
+size_t Frame::orient_outer(std::vector<Point2>& _pts_2d,
+  const std::vector<size_t>& _loop_ends)
+{
+  size_t outer = 0;
+  double outer_area = 0;
+  size_t beg = 0;
+  for (size_t i = 0; i < _loop_ends.size(); beg = _loop_ends[i++])
+  {
+    double area = 0;
+    for (size_t j = beg, k = _loop_ends[i] - 1; j < _loop_ends[i]; k = j++)
+      area += _pts_2d[k] % _pts_2d[j];
+    if (std::fabs(area) > std::fabs(outer_area))
+    {
+      outer_area = area;
+      outer = i;
+    }
+  }
+  if (outer_area < 0)
+  {
+    for (auto& pt : _pts_2d)
+      pt[1] = -pt[1];
+    axes_[1] = -axes_[1];
+    norm_ = -norm_;
+  }
+  return outer;
+}
+
+}//namespace PolyTriang
@@ -0,0 +1,407 @@
+#include "priv.hh"
+#include "Utils/error_handling.hh"
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+namespace PolyTriang {
+
+namespace {
+
+// Partition of the polygon in y-monotone pieces (de Berg et al.,
+// Computational Geometry, chapter 3). Produces the list of diagonals.
+struct Sweep
+{
+  Sweep(const std::vector<Point2>& _pts, const Ring& _ring)
+    : pts_(_pts), ring_(_ring), status_(EdgeLess{ this }) {}
+
+  void partition(std::vector<std::array<size_t, 2>>& _diags);
+
+private:
+  enum VertexType { START, END, SPLIT, MERGE, REGULAR };
+
+  // Edges are identified by their first point in the ring.
+  const Point2& upper(size_t _e) const
+  {
+    const auto& a = pts_[_e], &b = pts_[ring_.next_[_e]];
+    return above(a, b) ? a : b;
+  }
+  const Point2& lower(size_t _e) const
+  {
+    const auto& a = pts_[_e], &b = pts_[ring_.next_[_e]];
+    return above(a, b) ? b : a;
+  }
+
+  // Positive if _pt is at the right of the edge, negative if at its left.
+  double side(size_t _e, const Point2& _pt) const
+  {
+    return orient(upper(_e), lower(_e), _pt);
+  }
+
+  // Order of the edges crossing the sweep line, from left to right.
+  // QUERY stands for the point being processed.
+  static const size_t QUERY = Utils::INVALID_INDEX;
+  bool left_of(size_t _e0, size_t _e1) const
+  {
+    if (_e0 == _e1)
+      return false;
+    if (_e0 == QUERY)
+      return side(_e1, pts_[curr_]) < 0;
+    if (_e1 == QUERY)
+      return side(_e0, pts_[curr_]) > 0;
+    const auto& up0 = upper(_e0);
+    const auto& up1 = upper(_e1);
+    if (above(up1, up0)) // _e0 entered later, test it against _e1.
+    {
+      auto sd = side(_e1, up0);
+      if (sd == 0)
+        sd = side(_e1, lower(_e0));
+      return sd < 0;
+    }
+    auto sd = side(_e0, up1);
+    if (sd == 0)
+      sd = side(_e0, lower(_e1));
+    return sd > 0;
+  }
+
+  struct EdgeLess
+  {
+    const Sweep* swp_;
+    bool operator()(size_t _e0, size_t _e1) const
+    {
+      return swp_->left_of(_e0, _e1);
+    }
+  };
+  typedef std::set<size_t, EdgeLess> Status;
+
+  VertexType classify(size_t _v) const;
+  void insert(size_t _e, size_t _v);
+  void remove(size_t _e, size_t _v);
+  size_t left_edge(size_t _v);
+  void connect_merge_helper(size_t _e, size_t _v);
+
+  const std::vector<Point2>& pts_;
+  const Ring& ring_;
+  Status status_;
+  std::vector<Status::iterator> status_pos_;
+  std::vector<size_t> helper_;
+  std::vector<VertexType> types_;
+  std::vector<std::array<size_t, 2>>* diags_ = nullptr;
+  size_t curr_ = 0;
+};
+
+const size_t Sweep::QUERY;
+
+Sweep::VertexType Sweep::classify(size_t _v) const
+{
+  const auto& prev = pts_[ring_.prev_[_v]];
+  const auto& next = pts_[ring_.next_[_v]];
+  const auto& pt = pts_[_v];
+  const bool convex = orient(prev, pt, next) >= 0;
+  if (above(pt, prev) && above(pt, next))
+    return convex ? START : SPLIT;
+  if (above(prev, pt) && above(next, pt))
+    return convex ? END : MERGE;
+  return REGULAR;
+}
+
+void Sweep::insert(size_t _e, size_t _v)
+{
+  curr_ = _v;
+  status_pos_[_e] = status_.insert(_e).first;
+  helper_[_e] = _v;
+}
+
+void Sweep::remove(size_t _e, size_t _v)
+{
+  connect_merge_helper(_e, _v);
+  status_.erase(status_pos_[_e]);
+}
+
+size_t Sweep::left_edge(size_t _v)
+{
+  curr_ = _v;
+  auto it = status_.lower_bound(QUERY);
+  THROW_IF(it == status_.begin(), "Polygon is not simple.");
+  return *std::prev(it);
+}
+
+void Sweep::connect_merge_helper(size_t _e, size_t _v)
+{
+  if (types_[helper_[_e]] == MERGE)
+    diags_->push_back({ _v, helper_[_e] });
+}
+
+void Sweep::partition(std::vector<std::array<size_t, 2>>& _diags)
+{
+  diags_ = &_diags;
+  std::vector<size_t> events;
+  events.reserve(pts_.size());
+  for (size_t i = 0; i < pts_.size(); ++i)
+  {
+    if (ring_.used(i))
+      events.push_back(i);
+  }
+  std::sort(events.begin(), events.end(), [this](size_t _a, size_t _b)
+  {
+    return above(pts_[_a], pts_[_b]);
+  });
+  types_.resize(pts_.size());
+  for (auto v : events)
+    types_[v] = classify(v);
+  helper_.resize(pts_.size());
+  status_pos_.resize(pts_.size());
+
+  for (auto v : events)
+  {
+    const auto prev = ring_.prev_[v];
+    switch (types_[v])
+    {
+    case START:
+      insert(v, v);
+      break;
+    case END:
+      remove(prev, v);
+      break;
+    case SPLIT:
+    {
+      auto e = left_edge(v);
+      diags_->push_back({ v, helper_[e] });
+      helper_[e] = v;
+      insert(v, v);
+      break;
+    }
+    case MERGE:
+    {
+      remove(prev, v);
+      auto e = left_edge(v);
+      connect_merge_helper(e, v);
+      helper_[e] = v;
+      break;
+    }
+    case REGULAR:
+      if (above(pts_[prev], pts_[v])) // The inside is at the right.
+      {
+        remove(prev, v);
+        insert(v, v);
+      }
+      else
+      {
+        auto e = left_edge(v);
+        connect_merge_helper(e, v);
+        helper_[e] = v;
+      }
+      break;
+    }
+  }
+}
+
+void add_triangle(const std::vector<Point2>& _pts,
+  size_t _a, size_t _b, size_t _c, Sink& _tris)
+{
+  if (orient(_pts[_a], _pts[_b], _pts[_c]) < 0)
+    std::swap(_b, _c);
+  _tris.add({ _a, _b, _c });
+}
+
+// Triangulates a y-monotone counterclockwise polygon in linear time.
+void triangulate_monotone(const std::vector<Point2>& _pts,
+  const std::vector<size_t>& _face, Sink& _tris)
+{
+  const auto n = _face.size();
+  if (n < 3)
+    return;
+  if (n == 3)
+  {
+    add_triangle(_pts, _face[0], _face[1], _face[2], _tris);
+    return;
+  }
+  size_t top = 0, bot = 0;
+  for (size_t i = 1; i < n; ++i)
+  {
+    if (above(_pts[_face[i]], _pts[_face[top]]))
+      top = i;
+    if (above(_pts[_face[bot]], _pts[_face[i]]))
+      bot = i;
+  }
+  // Merge the left chain (forward from top) and the right chain (backward
+  // from top) in sweep order.
+  struct ChainPoint { size_t idx_; bool left_; };
+  std::vector<ChainPoint> srtd;
+  srtd.reserve(n);
+  srtd.push_back({ _face[top], true });
+  auto l = (top + 1) % n;
+  auto r = (top + n - 1) % n;
+  while (srtd.size() < n - 1)
+  {
+    if (r == bot || (l != bot && above(_pts[_face[l]], _pts[_face[r]])))
+    {
+      srtd.push_back({ _face[l], true });
+      l = (l + 1) % n;
+    }
+    else
+    {
+      srtd.push_back({ _face[r], false });
+      r = (r + n - 1) % n;
+    }
+  }
+  srtd.push_back({ _face[bot], true });
+
+  std::vector<ChainPoint> stack;
+  stack.reserve(n);
+  stack.push_back(srtd[0]);
+  stack.push_back(srtd[1]);
+  for (size_t j = 2; j < n - 1; ++j)
+  {
+    const auto& curr = srtd[j];
+    if (curr.left_ != stack.back().left_)
+    {
+      while (stack.size() > 1)
+      {
+        auto top_idx = stack.back().idx_;
+        stack.pop_back();
+        add_triangle(_pts, curr.idx_, top_idx, stack.back().idx_, _tris);
+      }
+      stack.pop_back();
+      stack.push_back(srtd[j - 1]);
+    }
+    else
+    {
+      auto last = stack.back();
+      stack.pop_back();
+      while (!stack.empty())
+      {
+        const auto& a = _pts[stack.back().idx_];
+        const auto& b = _pts[last.idx_];
+        const auto& c = _pts[curr.idx_];
+        if ((curr.left_ ? orient(a, b, c) : orient(c, b, a)) <= 0)
+          break;
+        add_triangle(_pts, curr.idx_, last.idx_, stack.back().idx_, _tris);
+        last = stack.back();
+        stack.pop_back();
+      }
+      stack.push_back(last);
+    }
+    stack.push_back(curr);
+  }
+  const auto last_idx = srtd.back().idx_;
+  while (stack.size() > 1)
+  {
+    auto top_idx = stack.back().idx_;
+    stack.pop_back();
+    add_triangle(_pts, last_idx, top_idx, stack.back().idx_, _tris);
+  }
+}
+
+// Counterclockwise angular order of directions.
+bool angle_less(const Point2& _a, const Point2& _b)
+{
+  auto half = [](const Point2& _d) { return _d[1] < 0 || (_d[1] == 0 && _d[0] < 0); };
+  const auto ha = half(_a), hb = half(_b);
+  if (ha != hb)
+    return hb;
+  return _a % _b > 0;
+}
+
+}//namespace
+
+void monotone(const std::vector<Point2>& _pts, const Ring& _ring,
+  Sink& _tris)
+{
+  std::vector<std::array<size_t, 2>> diags;
+  Sweep(_pts, _ring).partition(diags);
+  for (auto& diag : diags)
+  {
+    if (diag[1] < diag[0])
+      std::swap(diag[0], diag[1]);
+  }
+  std::sort(diags.begin(), diags.end());
+  diags.erase(std::unique(diags.begin(), diags.end()), diags.end());
+
+  // Adjacency of every point (boundary neighbours + diagonals) sorted
+  // counterclockwise, stored contiguously. The twin of a slot is the slot of
+  // the same edge at its other end.
+  const auto n = _pts.size();
+  std::vector<size_t> offs(n + 1, 0);
+  for (size_t i = 0; i < n; ++i)
+    offs[i + 1] = _ring.used(i) ? 2 : 0;
+  for (const auto& diag : diags)
+  {
+    ++offs[diag[0] + 1];
+    ++offs[diag[1] + 1];
+  }
+  std::partial_sum(offs.begin(), offs.end(), offs.begin());
+  std::vector<size_t> adj(offs.back()), twin(offs.back());
+  std::vector<size_t> fill(offs.begin(), offs.end() - 1);
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (!_ring.used(i))
+      continue;
+    // The first two slots of a point go to its previous and next point.
+    adj[fill[i]] = _ring.prev_[i];
+    twin[fill[i]++] = offs[_ring.prev_[i]] + 1;
+    adj[fill[i]] = _ring.next_[i];
+    twin[fill[i]++] = offs[_ring.next_[i]];
+  }
+  for (const auto& diag : diags)
+  {
+    twin[fill[diag[0]]] = fill[diag[1]];
+    twin[fill[diag[1]]] = fill[diag[0]];
+    adj[fill[diag[0]]++] = diag[1];
+    adj[fill[diag[1]]++] = diag[0];
+  }
+  // Sort the slots, then move the points and the twins to their new place.
+  std::vector<size_t> order(adj.size()), place(adj.size());
+  std::iota(order.begin(), order.end(), size_t(0));
+  for (size_t i = 0; i < n; ++i)
+  {
+    const auto& ctr = _pts[i];
+    std::sort(order.begin() + offs[i], order.begin() + offs[i + 1],
+      [&_pts, &adj, &ctr](size_t _a, size_t _b)
+    {
+      return angle_less(_pts[adj[_a]] - ctr, _pts[adj[_b]] - ctr);
+    });
+  }
+  for (size_t k = 0; k < order.size(); ++k)
+    place[order[k]] = k;
+  {
+    std::vector<size_t> sorted_adj(adj.size()), sorted_twin(adj.size());
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+      sorted_adj[k] = adj[order[k]];
+      sorted_twin[k] = place[twin[order[k]]];
+    }
+    adj.swap(sorted_adj);
+    twin.swap(sorted_twin);
+  }
+
+  // Every half edge with the inside on its left bounds exactly one monotone
+  // piece. Going around a piece, the next half edge is the first clockwise
+  // from the one we came from.
+  std::vector<bool> used(adj.size(), false);
+  std::vector<size_t> face;
+  for (size_t i = 0; i < n; ++i)
+  {
+    for (auto k = offs[i]; k < offs[i + 1]; ++k)
+    {
+      if (used[k] || adj[k] == _ring.prev_[i])
+        continue;
+      face.clear();
+      auto from = i;
+      auto slot = k;
+      while (!used[slot])
+      {
+        used[slot] = true;
+        face.push_back(from);
+        const auto to = adj[slot];
+        const auto back = twin[slot];
+        slot = back == offs[to] ? offs[to + 1] - 1 : back - 1;
+        from = to;
+      }
+      triangulate_monotone(_pts, face, _tris);
+    }
+  }
+}
+
+}//namespace PolyTriang
@@ -1,27 +1,71 @@
 #include "poly_triang.hh"
+#include "priv.hh"
 #include "Geo/area.hh"
-#include "Geo/entity.hh"
-#include "Geo/linear_system.hh"
 #include "Geo/point_in_polygon.hh"
 #include "Geo/tolerance.hh"
 #include "Utils/circular.hh"
 #include "Utils/statistics.hh"
 #include <Utils/error_handling.hh>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
 #include <numeric>
+#include <thread>
 
-struct PolygonTriangulation : public IPolygonTriangulation
+namespace {
+
+// The sums of the areas and the convexity tests are in double also for
+// float points.
+template <typename ScalarT>
+Geo::Vector3 to_double(const Geo::VectorT<ScalarT, 3>& _pt)
+{
+  return { double(_pt[0]), double(_pt[1]), double(_pt[2]) };
+}
+
+template <typename ScalarT>
+double triangle_area(const Geo::VectorT<ScalarT, 3>& _a,
+  const Geo::VectorT<ScalarT, 3>& _b, const Geo::VectorT<ScalarT, 3>& _c)
+{
+  return Geo::area(to_double(_a), to_double(_b), to_double(_c));
+}
+
+}//namespace
+
+template <typename ScalarT>
+struct PolygonTriangulation : public IPolygonTriangulationT<ScalarT>
 {
-  virtual void add(const std::vector<Geo::Vector3>& _plgn) override;
+  typedef IPolygonTriangulationBase::Strategy Strategy;
+  typedef IPolygonTriangulationBase::ISink ISink;
+  typedef std::vector<Geo::VectorT<ScalarT, 3>> Polygon;
+
+  PolygonTriangulation(Strategy _strat) : strat_(_strat) {}
+
+  virtual void add(const Polygon& _plgn) override;
+  virtual void add_view(const Polygon& _plgn) override;
+  virtual void reset() override;
+  virtual void set_parallel(size_t _min_size, size_t _thrd_nmbr) override
+  {
+    par_min_size_ = _min_size;
+    par_thrd_nmbr_ = _thrd_nmbr;
+    stored_ = false;
+  }
+  Strategy strategy() const { return strat_; }
   virtual const std::vector<std::array<size_t, 3>>& triangles() override
   {
     compute();
     return sol_.tris_;
   }
 
-  const std::vector<Geo::Vector3>& polygon() override
+  virtual void triangulate(ISink& _sink) override
+  {
+    compute(&_sink);
+  }
+
+  const Polygon& polygon() override
   {
     compute();
-    return loops_[0];
+    return poly_ == nullptr ? merged_ : *poly_;
   }
 
   virtual double area() override
@@ -30,197 +74,646 @@ struct PolygonTriangulation : public IPolygonTriangulation
     return sol_.area_;
   }
 
+
 private:
-  struct Solution
+  // Receives the triangles from the algorithms, adds up their area and
+  // stores them or passes them to the sink.
+  struct Solution : public ISink
   {
-    void compute(const std::vector<Geo::Vector3>& _pos,
+    void start(const Polygon& _pts, ISink* _sink)
+    {
+      pts_ = &_pts;
+      sink_ = _sink;
+      area_ = 0;
+      tris_.clear();
+    }
+    virtual void add(const std::array<size_t, 3>& _tri) override
+    {
+      const auto& pts = *pts_;
+      area_ += triangle_area(pts[_tri[0]], pts[_tri[1]], pts[_tri[2]]);
+      if (sink_ != nullptr)
+        sink_->add(_tri);
+      else
+        tris_.push_back(_tri);
+    }
+
+    void compute(const std::vector<PolyTriang::Point2>& _pts_2d,
       std::vector<size_t>& _indcs,
       const double _tols);
+    void compute_ears(const std::vector<PolyTriang::Point2>& _pts_2d,
+      const std::vector<size_t>& _indcs);
     bool concave(size_t _i) const
     {
       return _i < concav_.size() && concav_[_i];
     }
 
-    bool contain_concave(size_t _inds[3], Geo::Vector3 _vects[2],
-      const std::vector<Geo::Vector3>& _pts) const;
+    bool contain_concave(const size_t _inds[3],
+      const std::vector<PolyTriang::Point2>& _pts) const;
+
+    void find_concave(const std::vector<PolyTriang::Point2>& _pts);
 
-    bool find_concave(const std::vector<Geo::Vector3>& _pts,
-      std::vector<bool>& _concav) const;
+    // Ear clipping state on the positions of the ring: links of the
+    // vertices still to be cut, and the reflex ones (flagged in concav_).
+    bool ear(size_t _i, const std::vector<PolyTriang::Point2>& _pts) const;
+    void update_concave(size_t _i,
+      const std::vector<PolyTriang::Point2>& _pts);
+    void unmark_concave(size_t _i);
 
     std::vector<std::array<size_t, 3>> tris_;
     double area_ = 0;
+    const Polygon* pts_ = nullptr;
+    ISink* sink_ = nullptr;
     std::vector<bool> concav_;
+    std::vector<size_t> reflex_;
+    size_t reflex_dead_ = 0;
+    std::vector<size_t> prev_, next_;
+    std::vector<PolyTriang::Point2> ring_pts_;
+    std::vector<bool> ears_;
   };
 
-  void compute();
+  // Computes the triangulation if it is not stored yet. With a sink, the
+  // triangles are passed to it and not stored.
+  void compute(ISink* _sink = nullptr);
+  void compute_loops(ISink* _sink);
+  void compute_monotone(ISink* _sink);
+  bool compute_simple(ISink* _sink);
+
+  // Puts all the loops in one list of points and links them in a ring on
+  // their plane. Returns the index of the outer loop.
+  size_t init_ring();
+
+  // Triangulates the pieces of the loop indcs_ on many threads.
+  void compute_split(const Polygon& _poly, const double _tol,
+    const size_t _thrd_nmbr);
+
+  // Input loops, either viewed or copied in copies_. After reset the
+  // copies are reused to keep their memory.
+  std::vector<const Polygon*> loops_;
+  std::deque<Polygon> copies_;
+  size_t copy_nmbr_ = 0;
+  // All the points: the only loop or the loops one after the other.
+  const Polygon* poly_ = nullptr;
+  Polygon merged_;
+
+  // Buffers kept between triangulations.
+  std::vector<PolyTriang::Point2> pts_2d_;
+  PolyTriang::Ring ring_;
+  PolyTriang::Bridge bridge_;
+  std::vector<size_t> loop_ends_;
+  std::vector<size_t> orig_;
+  std::vector<size_t> same_;
+  std::vector<size_t> first_same_;
+  std::vector<size_t> indcs_;
 
-  typedef std::vector<Geo::Vector3> Polygon;
-  typedef std::vector<Polygon> PolygonVector;
-  PolygonVector loops_;
   Solution sol_;
+  bool stored_ = false;
+  Strategy strat_;
+
+  size_t par_min_size_ = SIZE_MAX; // Off until set_parallel.
+  size_t par_thrd_nmbr_ = 0;
+  std::vector<std::vector<size_t>> pieces_;
+  std::vector<Solution> piece_sols_;
 };
 
-std::shared_ptr<IPolygonTriangulation> IPolygonTriangulation::make()
+template <typename ScalarT>
+std::shared_ptr<IPolygonTriangulationT<ScalarT>> IPolygonTriangulationT<ScalarT>::make(
+  Strategy _strat)
 {
-  return std::make_shared<PolygonTriangulation>();
+  return std::make_shared<PolygonTriangulation<ScalarT>>(_strat);
 }
 
-void PolygonTriangulation::add(
-  const std::vector<Geo::Vector3>& _plgn)
+namespace {
+
+// Writes the triangles of a polygon in its slot of the output buffer.
+template <typename IndexT>
+struct SlotSink : public IPolygonTriangulationBase::ISink
+{
+  virtual void add(const std::array<size_t, 3>& _tri) override
+  {
+    THROW_IF(pos_ == end_, "Too many triangles.");
+    *pos_++ = { IndexT(_tri[0]), IndexT(_tri[1]), IndexT(_tri[2]) };
+  }
+  std::array<IndexT, 3>* pos_ = nullptr;
+  std::array<IndexT, 3>* end_ = nullptr;
+};
+
+template <typename ScalarT, typename IndexT>
+void triangulate_all_impl(
+  const std::vector<std::vector<Geo::VectorT<ScalarT, 3>>>& _polys,
+  std::vector<std::array<IndexT, 3>>& _tris,
+  std::vector<size_t>& _tri_ends,
+  IPolygonTriangulationBase::Strategy _strat)
 {
-  loops_.push_back(_plgn);
+  // A polygon with n points has at most n - 2 triangles: every polygon
+  // writes in its own slot of the buffer, compacted at the end.
+  const auto poly_nmbr = _polys.size();
+  std::vector<size_t> slots(poly_nmbr + 1, 0);
+  for (size_t i = 0; i < poly_nmbr; ++i)
+  {
+    const auto pt_nmbr = _polys[i].size();
+    THROW_IF(pt_nmbr > size_t(IndexT(-1)), "Polygon too big for the index type.");
+    slots[i + 1] = slots[i] + (pt_nmbr > 2 ? pt_nmbr - 2 : 0);
+  }
+  _tris.resize(slots.back());
+  _tri_ends.assign(poly_nmbr, 0);
+
+  const size_t CHUNK = 64;
+  std::atomic<size_t> next_poly(0);
+  auto work = [&]()
+  {
+    // The buffers of the triangulation stay with the thread of the pool.
+    static thread_local std::unique_ptr<PolygonTriangulation<ScalarT>> ptg;
+    if (!ptg || ptg->strategy() != _strat)
+    {
+      ptg.reset(new PolygonTriangulation<ScalarT>(_strat));
+      ptg->set_parallel(0, 0); // Already one polygon per thread.
+    }
+    SlotSink<IndexT> sink;
+    try
+    {
+      for (;;)
+      {
+        const auto beg = next_poly.fetch_add(CHUNK);
+        if (beg >= poly_nmbr)
+          break;
+        const auto end = std::min(beg + CHUNK, poly_nmbr);
+        for (auto i = beg; i < end; ++i)
+        {
+          if (_polys[i].size() < 3)
+            continue;
+          ptg->reset();
+          ptg->add_view(_polys[i]);
+          sink.pos_ = _tris.data() + slots[i];
+          sink.end_ = _tris.data() + slots[i + 1];
+          ptg->triangulate(sink);
+          _tri_ends[i] = sink.pos_ - (_tris.data() + slots[i]);
+        }
+      }
+    }
+    catch (...)
+    {
+      next_poly = poly_nmbr; // The other threads stop too.
+      ptg->reset();
+      throw;
+    }
+    ptg->reset(); // No view of the polygons is kept.
+  };
+  const auto chunk_nmbr = (poly_nmbr + CHUNK - 1) / CHUNK;
+  PolyTriang::WorkerPool::global().run(chunk_nmbr, work);
+
+  size_t tri_nmbr = 0;
+  for (size_t i = 0; i < poly_nmbr; ++i)
+  {
+    const auto beg = _tris.begin() + slots[i];
+    std::move(beg, beg + _tri_ends[i], _tris.begin() + tri_nmbr);
+    tri_nmbr += _tri_ends[i];
+    _tri_ends[i] = tri_nmbr;
+  }
+  _tris.resize(tri_nmbr);
+}
+
+}//namespace
+
+template <typename ScalarT>
+void IPolygonTriangulationT<ScalarT>::triangulate_all(
+  const std::vector<std::vector<Point>>& _polys,
+  std::vector<std::array<size_t, 3>>& _tris,
+  std::vector<size_t>& _tri_ends,
+  Strategy _strat)
+{
+  triangulate_all_impl(_polys, _tris, _tri_ends, _strat);
+}
+
+template <typename ScalarT>
+void IPolygonTriangulationT<ScalarT>::triangulate_all(
+  const std::vector<std::vector<Point>>& _polys,
+  std::vector<std::array<uint32_t, 3>>& _tris,
+  std::vector<size_t>& _tri_ends,
+  Strategy _strat)
+{
+  triangulate_all_impl(_polys, _tris, _tri_ends, _strat);
+}
+
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::add(const Polygon& _plgn)
+{
+  if (copy_nmbr_ == copies_.size())
+    copies_.emplace_back();
+  copies_[copy_nmbr_] = _plgn;
+  add_view(copies_[copy_nmbr_++]);
+}
+
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::add_view(const Polygon& _plgn)
+{
+  loops_.push_back(&_plgn);
+  poly_ = nullptr;
+  stored_ = false;
+}
+
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::reset()
+{
+  loops_.clear();
+  copy_nmbr_ = 0;
+  poly_ = nullptr;
+  merged_.clear();
+  stored_ = false;
   sol_.area_ = 0;
+  sol_.tris_.clear();
+}
+
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::compute(ISink* _sink)
+{
+  if (loops_.empty())
+    return;
+  if (stored_) // Triangulation already computed.
+  {
+    if (_sink != nullptr)
+    {
+      for (const auto& tri : sol_.tris_)
+        _sink->add(tri);
+    }
+    return;
+  }
+  // Stored only when complete: after an exception it is computed again.
+  compute_loops(_sink);
+  stored_ = _sink == nullptr;
 }
 
-void PolygonTriangulation::compute()
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::compute_loops(ISink* _sink)
 {
-  if (sol_.area_ > 0 || loops_.empty())
-    return; // Triangulation already computed.
+  if (compute_simple(_sink))
+    return;
+
+  size_t all_pt_nmbr = 0;
+  for (const auto& loop : loops_)
+    all_pt_nmbr += loop->size();
+  const auto thrd_nmbr = par_thrd_nmbr_ > 0 ? par_thrd_nmbr_ :
+    std::max(std::thread::hardware_concurrency(), 1u);
+  const bool split = par_min_size_ > 0 && all_pt_nmbr >= par_min_size_ &&
+    thrd_nmbr > 1;
+
+  if (strat_ == Strategy::MONOTONE && !split)
+  {
+    compute_monotone(_sink);
+    return;
+  }
 
   Utils::StatisticsT<double> tol_max;
   for (const auto& loop : loops_)
-    for (const auto& pt : loop)
+    for (const auto& pt : *loop)
       tol_max.add(Geo::epsilon(pt));
   const auto tol = tol_max.max() * 10;
 
-  if (loops_.size() > 1)
+  const auto outer = init_ring();
+  const auto first = bridge_(pts_2d_, ring_, loop_ends_, outer, orig_);
+
+  // Coincident points, as the bridge ends, share the same index.
+  const auto& poly = *poly_;
+  const auto pt_nmbr = poly.size();
+  same_.resize(pt_nmbr);
+  std::iota(same_.begin(), same_.end(), 0);
+  std::sort(same_.begin(), same_.end(), [&poly](size_t _a, size_t _b)
+  {
+    return poly[_a] < poly[_b] || (poly[_a] == poly[_b] && _a < _b);
+  });
+  first_same_.resize(pt_nmbr);
+  for (size_t i = 0; i < pt_nmbr; ++i)
   {
-    // Put the outer loop at the begin of the list.
-    auto pt = loops_[0][0];
-    for (auto loop_it = std::next(loops_.begin());
-      loop_it != loops_.end(); 
-      ++loop_it)
+    first_same_[same_[i]] = i > 0 && poly[same_[i]] == poly[same_[i - 1]] ?
+      first_same_[same_[i - 1]] : same_[i];
+  }
+
+  indcs_.clear();
+  if (first != Utils::INVALID_INDEX)
+  {
+    auto v = first;
+    do
     {
-      auto where = 
-        Geo::PointInPolygon::classify(*loop_it, pt, tol);
-      if (where == Geo::PointInPolygon::Inside)
-      {
-        std::swap(loops_.front(), *loop_it);
-        break;
-      }
+      const auto ind = first_same_[orig_[v]];
+      if (indcs_.empty() || indcs_.back() != ind)
+        indcs_.push_back(ind);
+      v = ring_.next_[v];
+    } while (v != first);
+    if (indcs_.size() > 1 && indcs_.back() == indcs_.front())
+      indcs_.pop_back();
+  }
+  sol_.start(poly, _sink);
+  if (split)
+    compute_split(poly, tol, thrd_nmbr);
+  else if (strat_ == Strategy::EAR_CLIPPING)
+    sol_.compute_ears(pts_2d_, indcs_);
+  else
+    sol_.compute(pts_2d_, indcs_, tol);
+}
+
+namespace {
+
+// Maps the indices of the points of a piece to the ones of the polygon.
+struct PieceSink : public IPolygonTriangulationBase::ISink
+{
+  virtual void add(const std::array<size_t, 3>& _tri) override
+  {
+    const auto& piece = *piece_;
+    out_->add({ piece[_tri[0]], piece[_tri[1]], piece[_tri[2]] });
+  }
+  const std::vector<size_t>* piece_ = nullptr;
+  IPolygonTriangulationBase::ISink* out_ = nullptr;
+};
+
+}//namespace
+
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::compute_split(const Polygon& _poly,
+  const double _tol, const size_t _thrd_nmbr)
+{
+  // More pieces than threads, as the sizes are not exactly balanced.
+  const auto max_size = std::max<size_t>(indcs_.size() / (2 * _thrd_nmbr), 4);
+  PolyTriang::split(pts_2d_, indcs_, max_size, pieces_);
+  if (piece_sols_.size() < pieces_.size())
+    piece_sols_.resize(pieces_.size());
+
+  // The sweep needs a simple loop: if a point is repeated, as on the
+  // bridges to the islands, the pieces are cut in ears.
+  bool sweep = strat_ == Strategy::MONOTONE;
+  if (sweep)
+  {
+    same_.assign(_poly.size(), 0);
+    for (auto ind : indcs_)
+    {
+      if (same_[ind]++ > 0)
+        sweep = false;
     }
-    while (loops_.size() > 1)
+  }
+
+  std::atomic<size_t> next_piece(0);
+  auto work = [&]()
+  {
+    // Kept by the threads of the pool between the triangulations.
+    static thread_local std::vector<PolyTriang::Point2> piece_pts;
+    static thread_local PolyTriang::Ring piece_ring;
+    std::vector<size_t> piece_ends(1);
+    PieceSink piece_sink;
+    try
     {
-      Utils::StatisticsT<double> stats;
-      auto pt0 = loops_[0].back();
-      std::tuple<Polygon::iterator,       // Near segment end on outer loop.
-                 PolygonVector::iterator, // Nearest internal poop
-                 Polygon::iterator,       // Nearest vertex on the intrnal loop
-                 double>                  // Projection parameter
-        conn_info, best_conn_info;
-      for (std::get<0>(conn_info) = loops_[0].begin();
-        std::get<0>(conn_info) != loops_[0].end(); 
-        pt0 = *(std::get<0>(conn_info)++))
+      for (;;)
       {
-        Geo::Segment seg = { pt0, *std::get<0>(conn_info) };
-        for (std::get<1>(conn_info) = std::next(loops_.begin());
-          std::get<1>(conn_info) != loops_.end();
-          ++std::get<1>(conn_info))
+        const auto i = next_piece++;
+        if (i >= pieces_.size())
+          break;
+        auto& sol = piece_sols_[i];
+        auto& piece = pieces_[i];
+        sol.start(_poly, nullptr);
+        if (sweep)
         {
-          for (std::get<2>(conn_info) = std::get<1>(conn_info)->begin();
-            std::get<2>(conn_info) != std::get<1>(conn_info)->end();
-            ++std::get<2>(conn_info))
-          {
-            double dist_sq;
-            if (!Geo::closest_point(seg, *std::get<2>(conn_info),
-              nullptr, &std::get<3>(conn_info), &dist_sq))
-            {
-              continue;
-            }
-            if (stats.add(dist_sq) & stats.Smallest)
-              best_conn_info = conn_info;
-          }
+          piece_pts.clear();
+          for (auto ind : piece)
+            piece_pts.push_back(pts_2d_[ind]);
+          piece_ends[0] = piece.size();
+          piece_ring.init(piece_pts, piece_ends, 0);
+          piece_sink.piece_ = &piece;
+          piece_sink.out_ = &sol;
+          PolyTriang::monotone(piece_pts, piece_ring, piece_sink);
         }
+        else if (strat_ == Strategy::MIN_ANGLE)
+          sol.compute(pts_2d_, piece, _tol);
+        else
+          sol.compute_ears(pts_2d_, piece);
       }
-      if (std::get<3>(best_conn_info) < 0.5)
-      {
-        if (std::get<0>(best_conn_info) == loops_[0].begin())
-          std::get<0>(best_conn_info) = loops_[0].end();
-        --std::get<0>(best_conn_info);
-      }
-      std::rotate(std::get<1>(best_conn_info)->begin(),
-        std::get<2>(best_conn_info), std::get<1>(best_conn_info)->end());
-      std::get<1>(best_conn_info)->push_back(
-        std::get<1>(best_conn_info)->front());
-      std::get<1>(best_conn_info)->insert(
-        std::get<1>(best_conn_info)->begin(),
-        *std::get<0>(best_conn_info));
-      loops_[0].insert(std::next(std::get<0>(best_conn_info)),
-        std::get<1>(best_conn_info)->crbegin(),
-        std::get<1>(best_conn_info)->crend());
-      loops_.erase(std::get<1>(best_conn_info));
     }
+    catch (...)
+    {
+      next_piece = pieces_.size(); // The other threads stop too.
+      throw;
+    }
+  };
+  PolyTriang::WorkerPool::global().run(std::min(_thrd_nmbr, pieces_.size()), work);
+
+  for (size_t i = 0; i < pieces_.size(); ++i)
+  {
+    for (const auto& tri : piece_sols_[i].tris_)
+      sol_.add(tri);
+  }
+}
+
+// Triangles, quads and convex polygons are done directly, with one pass
+// on the points and no 2d projection.
+template <typename ScalarT>
+bool PolygonTriangulation<ScalarT>::compute_simple(ISink* _sink)
+{
+  if (loops_.size() != 1)
+    return false;
+  const auto& plgn = *loops_[0];
+  const auto n = plgn.size();
+  if (n < 3)
+    return false;
+  auto pt = [&plgn](size_t _i) { return to_double(plgn[_i]); };
+  Geo::Vector3 norm = { 0, 0, 0 };
+  for (size_t i = 0, j = n - 1; i < n; j = i++)
+    norm += pt(j) % pt(i);
+
+  // Every turn must be to the left but for one concave quad vertex, and
+  // the edge direction must go around once (a star turns always left too).
+  const auto ref = norm % (pt(1) - pt(0));
+  size_t concave = 0, conc_idx = 0, turns = 0;
+  auto dir = pt(0) - pt(n - 1);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const auto next_dir = pt(i + 1 < n ? i + 1 : 0) - pt(i);
+    const auto turn = (dir % next_dir) * norm;
+    if (turn == 0)
+      return false;
+    if (turn < 0)
+    {
+      ++concave;
+      conc_idx = i;
+    }
+    if (dir * ref < 0 && next_dir * ref >= 0)
+      ++turns;
+    dir = next_dir;
   }
-  std::vector<rsize_t> indcs;
-  indcs.reserve(loops_[0].size());
-  auto prev = &loops_[0].back();
-  for (size_t i = 0, j; i < loops_[0].size(); prev = &loops_[0][i++])
+  if (turns != 1 || (concave > 0 && (n != 4 || concave > 1)))
+    return false;
+
+  poly_ = &plgn;
+  sol_.start(plgn, _sink);
+  if (n == 4)
   {
-    for (j = 0; j < i; ++j)
+    // Cut on the concave vertex or on the Delaunay diagonal: 0-2 unless 3
+    // is inside the circle through 0, 1, 2 on the coordinate plane closest
+    // to the polygon (where it is counterclockwise if norm[k] > 0).
+    size_t first = conc_idx;
+    if (concave == 0)
     {
-      if (loops_[0][i] == loops_[0][j])
+      size_t k = 0;
+      for (size_t i = 1; i < 3; ++i)
       {
-        indcs.push_back(j);
-        loops_[0].erase(loops_[0].begin() + (i--));
-        break;
+        if (std::fabs(norm[i]) > std::fabs(norm[k]))
+          k = i;
       }
+      auto proj = [k](const Geo::Vector3& _pt)
+      {
+        return PolyTriang::Point2{ _pt[(k + 1) % 3], _pt[(k + 2) % 3] };
+      };
+      if (Geo::incircle(proj(pt(0)), proj(pt(1)), proj(pt(2)),
+        proj(pt(3))) * norm[k] > 0)
+      {
+        first = 1;
+      }
+    }
+    sol_.add({ first, (first + 1) % 4, (first + 2) % 4 });
+    sol_.add({ first, (first + 2) % 4, (first + 3) % 4 });
+  }
+  else
+  {
+    for (size_t i = 1; i + 1 < n; ++i)
+      sol_.add({ 0, i, i + 1 });
+  }
+  return true;
+}
+
+template <typename ScalarT>
+size_t PolygonTriangulation<ScalarT>::init_ring()
+{
+  loop_ends_.clear();
+  if (loops_.size() == 1)
+    poly_ = loops_[0];
+  else
+  {
+    merged_.clear();
+    for (const auto& loop : loops_)
+    {
+      merged_.insert(merged_.end(), loop->begin(), loop->end());
+      loop_ends_.push_back(merged_.size());
     }
-    if (j == i)
-      indcs.push_back(j);
+    poly_ = &merged_;
   }
-  sol_.compute(loops_[0], indcs, tol);
+  if (loop_ends_.empty())
+    loop_ends_.push_back(poly_->size());
+
+  // One plane fit for all the loops, then every test runs in 2d.
+  PolyTriang::Frame frame;
+  frame.init(*poly_);
+  frame.project(*poly_, pts_2d_);
+  const auto outer = frame.orient_outer(pts_2d_, loop_ends_);
+  ring_.init(pts_2d_, loop_ends_, outer);
+  return outer;
+}
+
+// The sweep handles the islands directly, no bridge is needed.
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::compute_monotone(ISink* _sink)
+{
+  init_ring();
+  sol_.start(*poly_, _sink);
+  PolyTriang::monotone(pts_2d_, ring_, sol_);
 }
 
 namespace {
+
+typedef PolyTriang::Point2 Point2;
+
+// 2d version of Geo::PointInPolygon::classify on the polygon _indcs.
+Geo::PointInPolygon::Classification classify(
+  const std::vector<size_t>& _indcs,
+  const std::vector<Point2>& _pts,
+  const Point2& _pt,
+  const double _tol)
+{
+  const auto tol_sq = Geo::sq(_tol);
+  for (const auto& ind : _indcs)
+  {
+    if (Geo::length_square(_pts[ind] - _pt) < tol_sq)
+      return Geo::PointInPolygon::On;
+  }
+  bool inside = false;
+  auto prev = _indcs.back();
+  auto v0 = _pts[prev] - _pt;
+  for (const auto& ind : _indcs)
+  {
+    auto v1 = _pts[ind] - _pt;
+    if (v0 * v1 < 0)
+    {
+      double h = 0.25 * Geo::sq(v0 % v1) / Geo::length_square(v0 - v1);
+      if (h < tol_sq)
+        return Geo::PointInPolygon::On;
+    }
+    if ((v0[1] > 0) != (v1[1] > 0) &&
+      (PolyTriang::orient(_pts[prev], _pts[ind], _pt) > 0) == (v1[1] > v0[1]))
+    {
+      inside = !inside;
+    }
+    v0 = v1;
+    prev = ind;
+  }
+  return inside ? Geo::PointInPolygon::Inside : Geo::PointInPolygon::Outside;
+}
+
+// True if the segments cross or touch, false if they are collinear.
+bool intersect(const Point2& _a0, const Point2& _a1,
+  const Point2& _b0, const Point2& _b1)
+{
+  const auto ob0 = PolyTriang::orient(_a0, _a1, _b0);
+  const auto ob1 = PolyTriang::orient(_a0, _a1, _b1);
+  if (ob0 == 0 && ob1 == 0)
+    return false;
+  if ((ob0 > 0 && ob1 > 0) || (ob0 < 0 && ob1 < 0))
+    return false;
+  const auto oa0 = PolyTriang::orient(_b0, _b1, _a0);
+  const auto oa1 = PolyTriang::orient(_b0, _b1, _a1);
+  return !((oa0 > 0 && oa1 > 0) || (oa0 < 0 && oa1 < 0));
+}
+
 //!Find if the triangle is completely insidethe polygon
 bool valid_triangle(const size_t _i,
-  const std::vector<size_t>& _indcs, 
-  const std::vector<Geo::Vector3>&  _pts,
+  const std::vector<size_t>& _indcs,
+  const std::vector<Point2>& _pts,
   const double _tol)
 {
   auto next = _i;
   auto prev = Utils::decrease(
     Utils::decrease(_i, _indcs.size()), _indcs.size());
-  std::vector<Geo::Vector3> tmp_poly;
-  for (const auto& ind : _indcs)
-    tmp_poly.push_back(_pts[ind]);
-  auto pt_in = (tmp_poly[prev] + tmp_poly[next]) * 0.5;
-  auto where = Geo::PointInPolygon::classify(tmp_poly, pt_in, _tol);
+  const auto& pt_prev = _pts[_indcs[prev]];
+  const auto& pt_next = _pts[_indcs[next]];
+  auto pt_in = (pt_prev + pt_next) * 0.5;
+  auto where = classify(_indcs, _pts, pt_in, _tol);
   if (where != Geo::PointInPolygon::Inside)
     return false;
-  auto j = tmp_poly.size() - 1;
-  Geo::Segment seg = {tmp_poly[prev], tmp_poly[next]};
-  for (size_t i = 0; i < tmp_poly.size(); j = i++)
+  auto j = _indcs.size() - 1;
+  for (size_t i = 0; i < _indcs.size(); j = i++)
   {
     if (_indcs[i] == _indcs[next] || _indcs[i] == _indcs[prev] ||
       _indcs[j] == _indcs[next] || _indcs[j] == _indcs[prev])
       continue;
-    Geo::Segment pol_seg = {tmp_poly[i], tmp_poly[j]};
-    if (Geo::closest_point(seg, pol_seg))
+    if (intersect(pt_prev, pt_next, _pts[_indcs[i]], _pts[_indcs[j]]))
       return false;
   }
   return true;
 }
 };
 
-void PolygonTriangulation::Solution::compute(
-  const std::vector<Geo::Vector3>& _pts,
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::Solution::compute(
+  const std::vector<PolyTriang::Point2>& _pts_2d,
   std::vector<size_t>& _indcs,
   const double _tol)
 {
   while (_indcs.size() > 3)
   {
-    Geo::Vector3 vects[2];
+    Point2 vects[2];
     size_t inds[3] = { *(_indcs.end() - 2), _indcs.back(), 0 };
-    vects[0] = _pts[inds[0]] - _pts[inds[1]];
+    vects[0] = _pts_2d[inds[0]] - _pts_2d[inds[1]];
     Utils::StatisticsT<double> min_ang;
     for (size_t i = 0; i < _indcs.size(); ++i)
     {
       inds[2] = _indcs[i];
-      vects[1] = _pts[inds[2]] - _pts[inds[1]];
-      if (valid_triangle(i, _indcs, _pts, _tol))
+      vects[1] = _pts_2d[inds[2]] - _pts_2d[inds[1]];
+      if (valid_triangle(i, _indcs, _pts_2d, _tol))
       {
-        auto angl = Geo::angle(vects[0], vects[1]);
+        auto angl = std::atan2(std::fabs(vects[0] % vects[1]), vects[0] * vects[1]);
         min_ang.add(angl, i);
       }
       inds[0] = inds[1];
@@ -229,7 +722,9 @@ void PolygonTriangulation::Solution::compute(
     }
     if (min_ang.count() == 0)
     {
-      THROW("No good triangle found.");
+      // Only degenerate corners are left, the ear clipping handles them.
+      compute_ears(_pts_2d, _indcs);
+      return;
     }
     std::array<size_t, 3> tri;
     tri[2] = min_ang.min_idx();
@@ -239,7 +734,7 @@ void PolygonTriangulation::Solution::compute(
     {
       tri[0] = Utils::decrease(tri[1], _indcs.size());
       for (auto& pt_ind : tri) pt_ind = _indcs[pt_ind];
-      tris_.push_back(tri);
+      add(tri);
     }
     _indcs.erase(_indcs.begin() + to_rem);
   }
@@ -247,89 +742,208 @@ void PolygonTriangulation::Solution::compute(
   {
     std::array<size_t, 3> tri = { 0, 1, 2 };
     for (auto& pt_ind : tri) pt_ind = _indcs[pt_ind];
-    tris_.push_back(tri);
+    add(tri);
   }
-  area_ = 0.;
-  for (const auto& tri : tris_)
-    area_ += Geo::area(_pts[tri[0]], _pts[tri[1]], _pts[tri[2]]);
 }
 
 namespace {
 
 // return 0 - outside, 1 - on boundary, 2 - inside
-size_t inside_triangle(
-  const Geo::Vector3 _vert[2],
-  const Geo::Vector3& _test_pt)
+size_t inside_triangle(const Point2& _pt,
+  const Point2& _vrt0,
+  const Point2& _vrt1,
+  const Point2& _vrt2
+  )
 {
-  double A[2][2], B[2], X[2];
-  for (int i = 0; i < 2; ++i)
+  double orients[3] = {
+    PolyTriang::orient(_vrt0, _vrt1, _pt),
+    PolyTriang::orient(_vrt1, _vrt2, _pt),
+    PolyTriang::orient(_vrt2, _vrt0, _pt) };
+  if (PolyTriang::orient(_vrt0, _vrt1, _vrt2) < 0)
   {
-    for (int j = i; j < 2; ++j)
-      A[i][j] = A[j][i] = _vert[i] * _vert[j];
-    B[i] = _vert[i] * _test_pt;
+    for (auto& orient : orients)
+      orient = -orient;
   }
-  if (!Geo::solve_2x2(A, X, B))
-    return 0;
-
   size_t result = 0;
-  if (X[0] >= 0 && X[1] >= 0 && (X[0] + X[1]) <= 1)
+  if (orients[0] >= 0 && orients[1] >= 0 && orients[2] >= 0)
   {
     ++result;
-    if (X[0] > 0 && X[1] > 0 && (X[0] + X[1]) < 1)
+    if (orients[0] > 0 && orients[1] > 0 && orients[2] > 0)
       ++result;
   }
   return result;
 }
 
-size_t inside_triangle(const Geo::Vector3& _pt,
-  const Geo::Vector3& _vrt0, 
-  const Geo::Vector3& _vrt1, 
-  const Geo::Vector3& _vrt2
-  )
-{
-  const Geo::Vector3 verts[2] = { _vrt1 - _vrt0, _vrt2 - _vrt0 };
-  return inside_triangle(verts, _pt - _vrt0);
-}
-
 }
 
-bool PolygonTriangulation::Solution::find_concave(
-  const std::vector<Geo::Vector3>& _pts,
-  std::vector<bool>& _concav) const
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::Solution::find_concave(
+  const std::vector<PolyTriang::Point2>& _pts)
 {
-  bool achange = false;
-  _concav.resize(_pts.size());
+  concav_.assign(_pts.size(), false);
+  reflex_.clear();
+  reflex_dead_ = 0;
   for (size_t i = 0; i < _pts.size(); ++i)
   {
-    _concav[i] = concave(i);
-    size_t inside = 0;
-    for (const auto& tri : tris_)
+    // Flat vertices count as concave, they can hide a touching boundary.
+    if (PolyTriang::orient(_pts[prev_[i]], _pts[i], _pts[next_[i]]) <= 0)
     {
-      if (std::find(tri.begin(), tri.end(), i) != tri.end())
-        continue;
-      inside += inside_triangle(
-        _pts[i], _pts[tri[0]], _pts[tri[1]], _pts[tri[2]]);
-      if (inside > 1)
-      {
-        _concav[i] = !_concav[i];
-        achange = true;
-        break;
-      }
+      concav_[i] = true;
+      reflex_.push_back(i);
     }
   }
-  return achange;
 }
 
-bool PolygonTriangulation::Solution::contain_concave(
-  size_t _inds[3], Geo::Vector3 _vects[2],
-  const std::vector<Geo::Vector3>& _pts) const
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::Solution::update_concave(
+  size_t _i, const std::vector<PolyTriang::Point2>& _pts)
+{
+  // Cutting an ear only reduces the angles of its neighbours, so a convex
+  // vertex never becomes concave.
+  if (!concav_[_i] ||
+    PolyTriang::orient(_pts[prev_[_i]], _pts[_i], _pts[next_[_i]]) <= 0)
+  {
+    return;
+  }
+  unmark_concave(_i);
+}
+
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::Solution::unmark_concave(size_t _i)
 {
-  for (auto i = 0; i < concav_.size(); ++i)
+  concav_[_i] = false;
+  if (++reflex_dead_ * 2 > reflex_.size())
+  {
+    reflex_.erase(std::remove_if(reflex_.begin(), reflex_.end(),
+      [this](size_t _j) { return !concav_[_j]; }), reflex_.end());
+    reflex_dead_ = 0;
+  }
+}
+
+template <typename ScalarT>
+bool PolygonTriangulation<ScalarT>::Solution::contain_concave(
+  const size_t _inds[3],
+  const std::vector<PolyTriang::Point2>& _pts) const
+{
+  for (auto i : reflex_)
   {
     if (i == _inds[0] || i == _inds[2] || !concav_[i])
       continue;
-    if (inside_triangle(_vects, _pts[i] - _pts[_inds[1]]))
+    // Vertices repeated by the island bridges do not obstruct the ear.
+    if (_pts[i] == _pts[_inds[0]] || _pts[i] == _pts[_inds[1]] ||
+      _pts[i] == _pts[_inds[2]])
+    {
+      continue;
+    }
+    if (inside_triangle(_pts[i], _pts[_inds[0]], _pts[_inds[1]], _pts[_inds[2]]))
       return true;
   }
   return false;
 }
+
+template <typename ScalarT>
+bool PolygonTriangulation<ScalarT>::Solution::ear(
+  size_t _i, const std::vector<PolyTriang::Point2>& _pts) const
+{
+  if (concav_[_i])
+    return false;
+  const size_t inds[3] = { prev_[_i], _i, next_[_i] };
+  return !contain_concave(inds, _pts);
+}
+
+template <typename ScalarT>
+void PolygonTriangulation<ScalarT>::Solution::compute_ears(
+  const std::vector<PolyTriang::Point2>& _pts_2d,
+  const std::vector<size_t>& _indcs)
+{
+  const auto n = _indcs.size();
+  if (n < 3)
+    return;
+  auto& ring_pts = ring_pts_;
+  ring_pts.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    ring_pts[i] = _pts_2d[_indcs[i]];
+  double area = 0;
+  for (size_t i = 0, j = n - 1; i < n; j = i++)
+    area += ring_pts[j] % ring_pts[i];
+  prev_.resize(n);
+  next_.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    prev_[i] = Utils::decrease(i, n);
+    next_[i] = Utils::increase(i, n);
+  }
+  if (area < 0)
+    std::swap(prev_, next_);
+
+  find_concave(ring_pts);
+  auto& ears = ears_;
+  ears.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    ears[i] = ear(i, ring_pts);
+
+  auto cut = [this, &ring_pts, &ears](size_t _i)
+  {
+    const auto prev = prev_[_i], next = next_[_i];
+    next_[prev] = next;
+    prev_[next] = prev;
+    for (auto j : { prev, next })
+    {
+      update_concave(j, ring_pts);
+      ears[j] = ear(j, ring_pts);
+    }
+  };
+
+  size_t curr = 0, left = n, misses = 0;
+  bool refreshed = false;
+  while (left > 3)
+  {
+    if (ears[curr])
+    {
+      add({ _indcs[prev_[curr]], _indcs[curr], _indcs[next_[curr]] });
+      cut(curr);
+      curr = next_[curr];
+      --left;
+      misses = 0;
+      refreshed = false;
+      continue;
+    }
+    curr = next_[curr];
+    if (++misses < left)
+      continue;
+    misses = 0;
+    // A whole turn without ears. The status of a vertex is updated only
+    // when a neighbour is cut, but removing a reflex vertex elsewhere can
+    // free it, so recompute all of them once before giving up.
+    if (!refreshed)
+    {
+      for (size_t i = 0, j = curr; i < left; ++i, j = next_[j])
+        ears[j] = ear(j, ring_pts);
+      refreshed = true;
+      continue;
+    }
+    // Only flat or not simple corners are left, drop a flat one.
+    size_t i = 0;
+    for (; i < left; ++i, curr = next_[curr])
+    {
+      if (PolyTriang::orient(ring_pts[prev_[curr]],
+        ring_pts[curr], ring_pts[next_[curr]]) == 0)
+      {
+        break;
+      }
+    }
+    if (i == left)
+      THROW("No good triangle found.");
+    // Out of the ring it must not obstruct the ears on its neighbours.
+    if (concav_[curr])
+      unmark_concave(curr);
+    cut(curr);
+    curr = next_[curr];
+    --left;
+    refreshed = false;
+  }
+  add({ _indcs[prev_[curr]], _indcs[curr], _indcs[next_[curr]] });
+}
+
+template struct IPolygonTriangulationT<float>;
+template struct IPolygonTriangulationT<double>;
@@ -1,7 +1,44 @@
+#pragma once
+
 #include "Geo/vector.hh"
+#include "Utils/enum.hh"
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+// Strategies and sinks, common to all the scalar types.
+struct IPolygonTriangulationBase
+{
+  // Algorithm used to compute the triangulation.
+  // MIN_ANGLE - repeatedly cuts the valid triangle with the smallest angle,
+  //             O(n^3) but it produces well shaped triangles.
+  // MONOTONE  - splits the polygon in monotone pieces with a plane sweep
+  //             and triangulates them in linear time, O(n log(n)).
+  // EAR_CLIPPING - cuts ears along the boundary, testing them only against
+  //             the reflex vertices, O(n r) with r reflex vertices.
+  MAKE_ENUM(Strategy, MIN_ANGLE, MONOTONE, EAR_CLIPPING)
+
+  // Receives the triangles one at a time.
+  struct ISink
+  {
+    virtual ~ISink() {}
+    virtual void add(const std::array<size_t, 3>& _tri) = 0;
+  };
+
+  // Sink that appends the triangles to a vector, converting the indices
+  // to IndexT (e.g. uint32_t to halve the memory of big meshes).
+  template <typename IndexT>
+  struct VectorSink : public ISink
+  {
+    VectorSink(std::vector<std::array<IndexT, 3>>& _tris) : tris_(_tris) {}
+    virtual void add(const std::array<size_t, 3>& _tri) override
+    {
+      tris_.push_back({ IndexT(_tri[0]), IndexT(_tri[1]), IndexT(_tri[2]) });
+    }
+    std::vector<std::array<IndexT, 3>>& tris_;
+  };
+};
+
 // Given a set of polygons, computes a triangulation.
 // Polygons are supposed to be approximately on a plane
 // mot intersecting and one of them must include all
@@ -9,22 +46,69 @@
 // Returns a vector of triplets accessible via the method
 // triangles. The triplets are indices of points in the vector
 // returned by the method polygon.
-struct IPolygonTriangulation
+// The points are float or double (ScalarT). The polygon is projected on
+// its plane in double, where the exact predicates work, so float polygons
+// get the same triangulation with half the memory. It is instantiated
+// for float and double.
+template <typename ScalarT>
+struct IPolygonTriangulationT : public IPolygonTriangulationBase
 {
+  typedef Geo::VectorT<ScalarT, 3> Point;
+
   // Add a polygon. The set of added polygons must one boundary +
   // a set of islands.
-  virtual void add(const std::vector<Geo::Vector3>& _plgn) = 0;
+  virtual void add(const std::vector<Point>& _plgn) = 0;
+
+  // Same as add, but the polygon is not copied: it must not change until
+  // the triangulation has been used.
+  virtual void add_view(const std::vector<Point>& _plgn) = 0;
 
-  // A list of triplets that are indeces of points in the vector 
+  // Removes all the polygons to triangulate new ones. The internal buffers
+  // are kept, so in a loop of reset, add and triangles the memory is
+  // allocated only for polygons bigger than the previous ones.
+  virtual void reset() = 0;
+
+  // Polygons with at least _min_size points are cut along diagonals in
+  // balanced pieces triangulated on _thrd_nmbr threads (0 for all the
+  // hardware ones), then the triangles are joined. It is off by default,
+  // as the triangles differ from the ones of the whole polygon; 0 or
+  // SIZE_MAX disables it.
+  virtual void set_parallel(size_t _min_size, size_t _thrd_nmbr = 0) = 0;
+
+  // A list of triplets that are indeces of points in the vector
   // returned by method polygon.
   virtual const std::vector<std::array<size_t, 3>>& triangles() = 0;
 
+  // Passes the triangles to the sink as they are found, without storing
+  // them. If the triangulation was already stored, it is replayed.
+  virtual void triangulate(ISink& _sink) = 0;
+
   // The area of the triangularization.
   virtual double area() = 0;
 
   // The vector of points. If there was only one input polygon,
   // it is exactly it.
-  virtual const std::vector<Geo::Vector3>& polygon() = 0;
+  virtual const std::vector<Point>& polygon() = 0;
+
+  static std::shared_ptr<IPolygonTriangulationT> make(
+    Strategy _strat = Strategy::MIN_ANGLE);
+
+  // Triangulates many independent polygons (without islands) using all the
+  // hardware threads. The triangles of the polygon i are stored in _tris
+  // between _tri_ends[i - 1] (0 for the first) and _tri_ends[i], and are
+  // indices of the points of the polygon.
+  static void triangulate_all(
+    const std::vector<std::vector<Point>>& _polys,
+    std::vector<std::array<size_t, 3>>& _tris,
+    std::vector<size_t>& _tri_ends,
+    Strategy _strat = Strategy::MIN_ANGLE);
+
+  // Same with 32 bit indices. Throws if a polygon has too many points.
+  static void triangulate_all(
+    const std::vector<std::vector<Point>>& _polys,
+    std::vector<std::array<uint32_t, 3>>& _tris,
+    std::vector<size_t>& _tri_ends,
+    Strategy _strat = Strategy::MIN_ANGLE);
+};//class IPolygonTriangulationT
 
-  static std::shared_ptr<IPolygonTriangulation> make();
-};//class IPolygonTriangulation
\ No newline at end of file
+typedef IPolygonTriangulationT<double> IPolygonTriangulation;
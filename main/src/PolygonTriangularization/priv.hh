@@ -0,0 +1,142 @@
+#pragma once
+
+#include "poly_triang.hh"
+#include "Geo/predicates.hh"
+#include "Geo/vector.hh"
+#include "Utils/index.hh"
+
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PolyTriang {
+
+typedef Geo::Vector<2> Point2;
+typedef IPolygonTriangulationBase::ISink Sink;
+
+// Twice the signed area of the triangle, positive if it is counterclockwise.
+// The sign is exact, so collinear points give always 0.
+inline double orient(const Point2& _a, const Point2& _b, const Point2& _c)
+{
+  return Geo::orient2d(_a, _b, _c);
+}
+
+// Sweep order: from top to bottom and from left to right on the same row.
+inline bool above(const Point2& _a, const Point2& _b)
+{
+  return _a[1] > _b[1] || (_a[1] == _b[1] && _a[0] < _b[0]);
+}
+
+// Orthonormal frame on the best fitting plane of a set of points, used to
+// run all the triangulation predicates in 2d.
+struct Frame
+{
+  // Float and double points, the frame is in double.
+  template <typename ScalarT>
+  void init(const std::vector<Geo::VectorT<ScalarT, 3>>& _pts);
+
+  template <typename ScalarT>
+  Point2 project(const Geo::VectorT<ScalarT, 3>& _pt) const
+  {
+    const Geo::Vector3 dist = {
+      _pt[0] - centr_[0], _pt[1] - centr_[1], _pt[2] - centr_[2] };
+    return { dist * axes_[0], dist * axes_[1] };
+  }
+
+  template <typename ScalarT>
+  void project(const std::vector<Geo::VectorT<ScalarT, 3>>& _pts,
+    std::vector<Point2>& _pts_2d) const;
+
+  // Finds the outer loop, the one with the largest area, between the loops
+  // stored one after the other in _pts_2d (_loop_ends[i] is one past the
+  // last point of loop i). If it is clockwise, the frame and the points are
+  // mirrored to make it counterclockwise. Returns the index of the loop.
+  size_t orient_outer(std::vector<Point2>& _pts_2d,
+    const std::vector<size_t>& _loop_ends);
+
+  Geo::Vector3 centr_;
+  Geo::Vector3 norm_;
+  std::array<Geo::Vector3, 2> axes_;
+};
+
+// Boundary of a polygon with islands as a doubly linked list of point indices.
+// The outer loop is counterclockwise and the islands are clockwise, so the
+// inside is always on the left. Repeated consecutive points are skipped and
+// have prev_ and next_ set to INVALID_INDEX.
+struct Ring
+{
+  void init(const std::vector<Point2>& _pts,
+    const std::vector<size_t>& _loop_ends, const size_t _outer);
+
+  bool used(const size_t _i) const { return next_[_i] != Utils::INVALID_INDEX; }
+
+  std::vector<size_t> prev_;
+  std::vector<size_t> next_;
+};
+
+// Joins the islands to the outer loop with bridges, so the ring becomes a
+// single loop. The bridge ends are copies of points appended to _pts and
+// _ring, _orig maps every point of the ring to the original one. Returns a
+// point of the loop. The buffers are kept between calls.
+struct Bridge
+{
+  size_t operator()(std::vector<Point2>& _pts, Ring& _ring,
+    const std::vector<size_t>& _loop_ends, const size_t _outer,
+    std::vector<size_t>& _orig);
+
+private:
+  std::vector<size_t> islands_;
+  std::vector<std::vector<size_t>> nodes_, rows_;
+};
+
+// Plane sweep partition in monotone polygons, each one triangulated in
+// linear time. Triangles are counterclockwise.
+void monotone(const std::vector<Point2>& _pts, const Ring& _ring,
+  Sink& _tris);
+
+// Cuts a counterclockwise loop of point indices along internal diagonals
+// in pieces with at most _max_size points, when balanced diagonals can be
+// found. The pieces are counterclockwise loops too.
+void split(const std::vector<Point2>& _pts, const std::vector<size_t>& _loop,
+  const size_t _max_size, std::vector<std::vector<size_t>>& _pieces);
+
+// Threads kept alive between the parallel triangulations, so their
+// thread_local buffers are reused too. run calls _job on _thrd_nmbr
+// threads, the calling one included, and waits for all of them; the jobs
+// take their work from a shared counter. The first exception of a job is
+// thrown again by run. A run nested in a job, or made while another
+// thread runs, calls _job on the calling thread only.
+class WorkerPool
+{
+public:
+  explicit WorkerPool(size_t _thrd_nmbr);
+  ~WorkerPool();
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // The pool with a thread for each hardware thread but the calling one.
+  static WorkerPool& global();
+
+  void run(size_t _thrd_nmbr, const std::function<void()>& _job);
+
+private:
+  void loop(size_t _i);
+  void execute(const std::function<void()>& _job);
+
+  std::vector<std::thread> thrds_;
+  std::mutex run_mtx_;
+  std::mutex mtx_;
+  std::condition_variable start_cv_, done_cv_;
+  const std::function<void()>* job_ = nullptr;
+  size_t helpers_ = 0; // Threads of the pool in the current run.
+  size_t running_ = 0;
+  size_t generation_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+};
+
+}//namespace PolyTriang
@@ -0,0 +1,61 @@
+#include "priv.hh"
+
+namespace PolyTriang {
+
+void Ring::init(const std::vector<Point2>& _pts,
+  const std::vector<size_t>& _loop_ends, const size_t _outer)
+{
+  const auto INVALID = Utils::INVALID_INDEX;
+  prev_.assign(_pts.size(), INVALID);
+  next_.assign(_pts.size(), INVALID);
+  size_t beg = 0;
+  for (size_t l = 0; l < _loop_ends.size(); beg = _loop_ends[l++])
+  {
+    const auto end = _loop_ends[l];
+    size_t first = INVALID, last = INVALID, count = 0;
+    for (size_t i = beg; i < end; ++i)
+    {
+      if (last != INVALID && _pts[i] == _pts[last])
+        continue;
+      if (last == INVALID)
+        first = i;
+      else
+      {
+        next_[last] = i;
+        prev_[i] = last;
+      }
+      last = i;
+      ++count;
+    }
+    while (count > 1 && _pts[last] == _pts[first])
+    {
+      auto prev = prev_[last];
+      prev_[last] = next_[prev] = INVALID;
+      last = prev;
+      --count;
+    }
+    if (count < 3)
+    {
+      for (size_t i = beg; i < end; ++i)
+        prev_[i] = next_[i] = INVALID;
+      continue;
+    }
+    next_[last] = first;
+    prev_[first] = last;
+
+    double area = 0;
+    auto i = first;
+    do
+    {
+      area += _pts[i] % _pts[next_[i]];
+      i = next_[i];
+    } while (i != first);
+    if ((area > 0) != (l == _outer))
+    {
+      for (size_t j = beg; j < end; ++j)
+        std::swap(prev_[j], next_[j]);
+    }
+  }
+}
+
+}//namespace PolyTriang
@@ -0,0 +1,244 @@
+#include "priv.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace PolyTriang {
+
+namespace {
+
+int sign(double _val)
+{
+  return (_val > 0) - (_val < 0);
+}
+
+// True if _pt is strictly between _a and _b on the line through them.
+bool between(const Point2& _a, const Point2& _b, const Point2& _pt)
+{
+  const size_t k = std::fabs(_b[0] - _a[0]) >= std::fabs(_b[1] - _a[1]) ? 0 : 1;
+  return std::min(_a[k], _b[k]) < _pt[k] && _pt[k] < std::max(_a[k], _b[k]);
+}
+
+// True if the closed segments have a common point.
+bool touch(const Point2& _a, const Point2& _b, const Point2& _c, const Point2& _d)
+{
+  const auto oc = sign(orient(_a, _b, _c)), od = sign(orient(_a, _b, _d));
+  if (oc == 0 && od == 0)
+    return between(_a, _b, _c) || between(_a, _b, _d) || between(_c, _d, _a) ||
+      _a == _c || _a == _d || _b == _c || _b == _d;
+  if (oc * od > 0)
+    return false;
+  return sign(orient(_c, _d, _a)) * sign(orient(_c, _d, _b)) <= 0;
+}
+
+// True if _pt is inside or on the boundary of the triangle.
+bool in_triangle(const Point2& _a, const Point2& _b, const Point2& _c,
+  const Point2& _pt)
+{
+  const auto o0 = orient(_a, _b, _pt);
+  const auto o1 = orient(_b, _c, _pt);
+  const auto o2 = orient(_c, _a, _pt);
+  return (o0 >= 0 && o1 >= 0 && o2 >= 0) || (o0 <= 0 && o1 <= 0 && o2 <= 0);
+}
+
+// Finds the diagonals of a counterclockwise loop of point indices. The
+// loop can touch itself, as the bridges to the islands do.
+struct Splitter
+{
+  Splitter(const std::vector<Point2>& _pts, const std::vector<size_t>& _loop)
+    : pts_(_pts), loop_(_loop), n_(_loop.size()) {}
+
+  // Finds a diagonal between the positions _p and _q that cuts the loop in
+  // two pieces with sizes as close as possible.
+  bool find(size_t& _p, size_t& _q) const;
+
+private:
+  const Point2& pt(size_t _pos) const { return pts_[loop_[_pos % n_]]; }
+  bool locally_inside(size_t _p, const Point2& _pt) const;
+  bool valid(size_t _p, size_t _q) const;
+  size_t visible(size_t _p, size_t _target) const;
+
+  const std::vector<Point2>& pts_;
+  const std::vector<size_t>& loop_;
+  const size_t n_;
+};
+
+// True if the segment from _p to _pt starts strictly inside the loop.
+bool Splitter::locally_inside(size_t _p, const Point2& _pt) const
+{
+  const auto& prev = pt(_p + n_ - 1);
+  const auto& curr = pt(_p);
+  const auto& next = pt(_p + 1);
+  if (orient(prev, curr, next) > 0)
+    return orient(curr, next, _pt) > 0 && orient(prev, curr, _pt) > 0;
+  return orient(curr, next, _pt) > 0 || orient(prev, curr, _pt) > 0;
+}
+
+bool Splitter::valid(size_t _p, size_t _q) const
+{
+  const auto& a = pt(_p);
+  const auto& b = pt(_q);
+  if (a == b || !locally_inside(_p, b) || !locally_inside(_q, a))
+    return false;
+  // The pieces are triangulated on their own: a diagonal almost through a
+  // point would leave a sliver that some engines do not handle.
+  const auto min_orient = 1e-10 * Geo::length_square(b - a);
+  for (size_t i = 0; i < n_; ++i)
+  {
+    const auto& c = pt(i);
+    const auto& d = pt(i + 1);
+    const bool c_end = c == a || c == b, d_end = d == a || d == b;
+    if (!c_end && std::fabs(orient(a, b, c)) <= min_orient && between(a, b, c))
+      return false;
+    if (c_end && d_end)
+    {
+      if (c != d) // An edge along the diagonal.
+        return false;
+    }
+    else if (c_end || d_end)
+    {
+      const auto& other = c_end ? d : c;
+      if (orient(a, b, other) == 0 && between(a, b, other))
+        return false;
+    }
+    else if (touch(a, b, c, d))
+      return false;
+  }
+  return true;
+}
+
+// Finds a point visible from _p in the direction of _target (D. Eberly,
+// Triangulation by ear clipping, with a generic ray direction).
+size_t Splitter::visible(size_t _p, size_t _target) const
+{
+  const auto INVALID = Utils::INVALID_INDEX;
+  const auto& a = pt(_p);
+  const auto& trgt = pt(_target);
+  if (!locally_inside(_p, trgt))
+    return INVALID;
+
+  // Nearest edge crossed by the ray.
+  const auto dir = trgt - a;
+  auto t_min = std::numeric_limits<double>::max();
+  size_t hit_e = INVALID;
+  for (size_t i = 0; i < n_; ++i)
+  {
+    const auto& c = pt(i);
+    const auto& d = pt(i + 1);
+    if (c == a || d == a)
+      continue;
+    const auto sc = sign(orient(a, trgt, c)), sd = sign(orient(a, trgt, d));
+    if (sc * sd > 0)
+      continue;
+    double t;
+    if (sc == 0 && sd == 0)
+      t = std::min((c - a) * dir, (d - a) * dir) / (dir * dir);
+    else
+    {
+      const auto den = dir % (d - c);
+      if (den == 0)
+        continue;
+      t = ((c - a) % (d - c)) / den;
+    }
+    if (t > 0 && t < t_min)
+    {
+      t_min = t;
+      hit_e = i;
+    }
+  }
+  if (hit_e == INVALID)
+    return INVALID;
+
+  // Of the two ends of the edge take the one nearer to the target along
+  // the loop. Points inside the triangle (a, hit, end) can hide it: take
+  // the one with the smallest angle with the ray.
+  const Point2 hit = a + dir * t_min;
+  auto loop_dist = [this, _target](size_t _pos)
+  {
+    const auto d = (_pos + n_ - _target % n_) % n_;
+    return std::min(d, n_ - d);
+  };
+  auto cand = loop_dist(hit_e) <= loop_dist(hit_e + 1) ? hit_e : (hit_e + 1) % n_;
+  const auto end = pt(cand);
+  auto tan = [&a, &dir](const Point2& _pt)
+  {
+    const auto dot = (_pt - a) * dir;
+    return dot > 0 ? std::fabs((_pt - a) % dir) / dot :
+      std::numeric_limits<double>::max();
+  };
+  auto tan_min = tan(end);
+  for (size_t i = 0; i < n_; ++i)
+  {
+    const auto& v = pt(i);
+    if (v == a || !in_triangle(a, hit, end, v))
+      continue;
+    const auto tan_v = tan(v);
+    if (tan_v < tan_min || (tan_v == tan_min && loop_dist(i) < loop_dist(cand)))
+    {
+      tan_min = tan_v;
+      cand = i;
+    }
+  }
+  return valid(_p, cand) ? cand : INVALID;
+}
+
+bool Splitter::find(size_t& _p, size_t& _q) const
+{
+  // From a few points try the opposite ones, then a ray towards them. Stop
+  // at the first piece with at least a third of the points. Most of the
+  // invalid diagonals are rejected in constant time by locally_inside.
+  const size_t TRIES = 8;
+  size_t best_size = n_ / 16;
+  for (size_t t = 0; t < TRIES && 3 * best_size < n_; ++t)
+  {
+    const auto p0 = t * n_ / TRIES;
+    for (size_t k = 0; k < 9; ++k)
+    {
+      // Near points, as on spiky loops only one in a few is visible.
+      const auto p = p0 + k % 2, q = p0 + n_ / 2 + k / 2;
+      const auto v = k < 8 ? (valid(p, q) ? q % n_ : Utils::INVALID_INDEX) :
+        visible(p0, q);
+      if (v == Utils::INVALID_INDEX)
+        continue;
+      const auto d = (v + n_ - p % n_) % n_;
+      const auto size = std::min(d, n_ - d);
+      if (size > best_size)
+      {
+        best_size = size;
+        _p = p % n_;
+        _q = v;
+        break;
+      }
+    }
+  }
+  return best_size > n_ / 16;
+}
+
+}//namespace
+
+void split(const std::vector<Point2>& _pts, const std::vector<size_t>& _loop,
+  const size_t _max_size, std::vector<std::vector<size_t>>& _pieces)
+{
+  _pieces.clear();
+  std::vector<std::vector<size_t>> todo(1, _loop);
+  while (!todo.empty())
+  {
+    auto loop = std::move(todo.back());
+    todo.pop_back();
+    size_t p = 0, q = 0;
+    if (loop.size() <= _max_size || !Splitter(_pts, loop).find(p, q))
+    {
+      _pieces.push_back(std::move(loop));
+      continue;
+    }
+    if (q < p)
+      std::swap(p, q);
+    todo.emplace_back(loop.begin() + p, loop.begin() + q + 1);
+    std::vector<size_t> rest(loop.begin() + q, loop.end());
+    rest.insert(rest.end(), loop.begin(), loop.begin() + p + 1);
+    todo.push_back(std::move(rest));
+  }
+}
+
+}//namespace PolyTriang
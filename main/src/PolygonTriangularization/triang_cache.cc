@@ -0,0 +1,215 @@
+#include "triang_cache.hh"
+#include <Utils/error_handling.hh>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+size_t hash(const std::vector<Geo::Vector3>& _plgn)
+{
+  // FNV-1a on the bits of the coordinates, + 0. makes -0 equal to 0.
+  uint64_t hsh = 14695981039346656037ull;
+  for (const auto& pt : _plgn)
+  {
+    for (const auto coord : pt)
+    {
+      const double val = coord + 0.;
+      uint64_t bits;
+      std::memcpy(&bits, &val, sizeof(bits));
+      hsh = (hsh ^ bits) * 1099511628211ull;
+    }
+  }
+  return size_t(hsh ^ (hsh >> 32));
+}
+
+struct TriangulationCache : public ITriangulationCache
+{
+  TriangulationCache(size_t _capacity, IPolygonTriangulation::Strategy _strat)
+    : capacity_(_capacity), strat_(_strat) {}
+
+  virtual std::shared_ptr<const Triangles> triangles(
+    const std::vector<Geo::Vector3>& _plgn) override;
+
+  virtual std::vector<std::shared_ptr<const Triangles>> triangles_all(
+    const std::vector<std::vector<Geo::Vector3>>& _plgns) override;
+
+  virtual void set_capacity(size_t _capacity) override
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    capacity_ = _capacity;
+    shrink();
+  }
+
+  virtual size_t size() const override
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return lru_.size();
+  }
+
+  virtual size_t hits() const override { return hits_; }
+  virtual size_t misses() const override { return misses_; }
+
+  virtual void clear() override
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    lru_.clear();
+    index_.clear();
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+private:
+  struct Entry
+  {
+    size_t hash_;
+    std::vector<Geo::Vector3> plgn_;
+    std::shared_ptr<const Triangles> tris_;
+  };
+  typedef std::list<Entry> Lru;
+
+  std::shared_ptr<const Triangles> find(size_t _hash,
+    const std::vector<Geo::Vector3>& _plgn);
+  std::shared_ptr<const Triangles> insert(size_t _hash,
+    const std::vector<Geo::Vector3>& _plgn, std::shared_ptr<const Triangles> _tris);
+  Lru::iterator locate(size_t _hash, const std::vector<Geo::Vector3>& _plgn);
+  void shrink();
+
+  size_t capacity_;
+  IPolygonTriangulation::Strategy strat_;
+  mutable std::mutex mtx_;
+  Lru lru_; // Most recently used first.
+  std::unordered_multimap<size_t, Lru::iterator> index_;
+  std::atomic<size_t> hits_{ 0 }, misses_{ 0 };
+};
+
+std::shared_ptr<const ITriangulationCache::Triangles>
+TriangulationCache::triangles(const std::vector<Geo::Vector3>& _plgn)
+{
+  const auto hsh = hash(_plgn);
+  if (auto tris = find(hsh, _plgn))
+    return tris;
+  // Computed out of the lock: other threads can use the cache meanwhile.
+  THROW_IF(_plgn.size() > size_t(uint32_t(-1)), "Polygon too big for the cache.");
+  auto tris = std::make_shared<Triangles>();
+  if (_plgn.size() > 2)
+  {
+    tris->reserve(_plgn.size() - 2);
+    IPolygonTriangulation::VectorSink<uint32_t> sink(*tris);
+    auto ptg = IPolygonTriangulation::make(strat_);
+    ptg->add_view(_plgn);
+    ptg->triangulate(sink);
+  }
+  return insert(hsh, _plgn, tris);
+}
+
+std::vector<std::shared_ptr<const ITriangulationCache::Triangles>>
+TriangulationCache::triangles_all(
+  const std::vector<std::vector<Geo::Vector3>>& _plgns)
+{
+  std::vector<std::shared_ptr<const Triangles>> result(_plgns.size());
+  std::vector<size_t> hashes(_plgns.size()), missing;
+  std::vector<std::vector<Geo::Vector3>> missing_plgns;
+  for (size_t i = 0; i < _plgns.size(); ++i)
+  {
+    hashes[i] = hash(_plgns[i]);
+    result[i] = find(hashes[i], _plgns[i]);
+    if (result[i])
+      continue;
+    missing.push_back(i);
+    missing_plgns.push_back(_plgns[i]);
+  }
+  if (missing.empty())
+    return result;
+
+  Triangles all_tris;
+  std::vector<size_t> tri_ends;
+  IPolygonTriangulation::triangulate_all(missing_plgns, all_tris, tri_ends, strat_);
+  size_t beg = 0;
+  for (size_t j = 0; j < missing.size(); beg = tri_ends[j++])
+  {
+    const auto i = missing[j];
+    auto tris = std::make_shared<Triangles>(
+      all_tris.begin() + beg, all_tris.begin() + tri_ends[j]);
+    result[i] = insert(hashes[i], _plgns[i], tris);
+  }
+  return result;
+}
+
+TriangulationCache::Lru::iterator TriangulationCache::locate(
+  size_t _hash, const std::vector<Geo::Vector3>& _plgn)
+{
+  auto rng = index_.equal_range(_hash);
+  for (auto it = rng.first; it != rng.second; ++it)
+  {
+    if (it->second->plgn_ == _plgn)
+      return it->second;
+  }
+  return lru_.end();
+}
+
+std::shared_ptr<const ITriangulationCache::Triangles> TriangulationCache::find(
+  size_t _hash, const std::vector<Geo::Vector3>& _plgn)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = locate(_hash, _plgn);
+  if (it == lru_.end())
+  {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  lru_.splice(lru_.begin(), lru_, it);
+  return it->tris_;
+}
+
+std::shared_ptr<const ITriangulationCache::Triangles> TriangulationCache::insert(
+  size_t _hash, const std::vector<Geo::Vector3>& _plgn,
+  std::shared_ptr<const Triangles> _tris)
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (capacity_ == 0)
+    return _tris;
+  // Another thread can have added it while it was computed.
+  auto it = locate(_hash, _plgn);
+  if (it != lru_.end())
+    return it->tris_;
+  lru_.push_front({ _hash, _plgn, _tris });
+  index_.emplace(_hash, lru_.begin());
+  shrink();
+  return _tris;
+}
+
+void TriangulationCache::shrink()
+{
+  while (lru_.size() > capacity_)
+  {
+    auto rng = index_.equal_range(lru_.back().hash_);
+    for (auto it = rng.first; it != rng.second; ++it)
+    {
+      if (it->second == std::prev(lru_.end()))
+      {
+        index_.erase(it);
+        break;
+      }
+    }
+    lru_.pop_back();
+  }
+}
+
+}//namespace
+
+std::shared_ptr<ITriangulationCache> ITriangulationCache::make(
+  size_t _capacity, IPolygonTriangulation::Strategy _strat)
+{
+  return std::make_shared<TriangulationCache>(_capacity, _strat);
+}
+
+ITriangulationCache& ITriangulationCache::global()
+{
+  static TriangulationCache cache(4096, IPolygonTriangulation::Strategy::MIN_ANGLE);
+  return cache;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "poly_triang.hh"
+
+// Thread safe cache of the triangulations of single polygons, keyed by the
+// coordinates of their points. A polygon equal point by point to one in the
+// cache costs a hash and a comparison. When the cache is full the least
+// recently used polygon is dropped.
+struct ITriangulationCache
+{
+  typedef std::vector<std::array<uint32_t, 3>> Triangles;
+
+  virtual ~ITriangulationCache() {}
+
+  // The triangles of the polygon, as indices of its points. They are
+  // computed and added to the cache if the polygon is not there.
+  virtual std::shared_ptr<const Triangles> triangles(
+    const std::vector<Geo::Vector3>& _plgn) = 0;
+
+  // Same as triangles, for many polygons: the missing ones are triangulated
+  // in parallel with IPolygonTriangulation::triangulate_all.
+  virtual std::vector<std::shared_ptr<const Triangles>> triangles_all(
+    const std::vector<std::vector<Geo::Vector3>>& _plgns) = 0;
+
+  // Maximum number of polygons kept. 0 disables the cache.
+  virtual void set_capacity(size_t _capacity) = 0;
+
+  virtual size_t size() const = 0;
+  virtual size_t hits() const = 0;
+  virtual size_t misses() const = 0;
+
+  // Removes all the polygons and resets the counters.
+  virtual void clear() = 0;
+
+  static std::shared_ptr<ITriangulationCache> make(size_t _capacity = 4096,
+    IPolygonTriangulation::Strategy _strat =
+    IPolygonTriangulation::Strategy::MIN_ANGLE);
+
+  // The cache used by Geo::IPolygonalFace.
+  static ITriangulationCache& global();
+};
@@ -0,0 +1,105 @@
+#include "priv.hh"
+
+#include <algorithm>
+
+namespace PolyTriang {
+
+namespace {
+
+// True on the threads of a pool and while a run executes its job.
+thread_local bool in_job = false;
+
+}//namespace
+
+WorkerPool::WorkerPool(size_t _thrd_nmbr)
+{
+  for (size_t i = 0; i < _thrd_nmbr; ++i)
+    thrds_.emplace_back(&WorkerPool::loop, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& thrd : thrds_)
+    thrd.join();
+}
+
+WorkerPool& WorkerPool::global()
+{
+  static WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+  return pool;
+}
+
+void WorkerPool::run(size_t _thrd_nmbr, const std::function<void()>& _job)
+{
+  std::unique_lock<std::mutex> run_lock(run_mtx_, std::defer_lock);
+  if (_thrd_nmbr <= 1 || thrds_.empty() || in_job || !run_lock.try_lock())
+  {
+    _job();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    job_ = &_job;
+    helpers_ = std::min(_thrd_nmbr - 1, thrds_.size());
+    running_ = helpers_;
+    error_ = nullptr;
+    ++generation_;
+  }
+  start_cv_.notify_all();
+  in_job = true;
+  execute(_job);
+  in_job = false;
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    done_cv_.wait(lock, [this]() { return running_ == 0; });
+    job_ = nullptr;
+    std::swap(error, error_);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void WorkerPool::loop(size_t _i)
+{
+  in_job = true;
+  size_t seen = 0;
+  std::unique_lock<std::mutex> lock(mtx_);
+  for (;;)
+  {
+    start_cv_.wait(lock, [this, &seen]() { return stop_ || generation_ != seen; });
+    if (stop_)
+      return;
+    seen = generation_;
+    if (_i >= helpers_)
+      continue;
+    auto job = job_;
+    lock.unlock();
+    execute(*job);
+    lock.lock();
+    if (--running_ == 0)
+      done_cv_.notify_all();
+  }
+}
+
+void WorkerPool::execute(const std::function<void()>& _job)
+{
+  try
+  {
+    _job();
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!error_)
+      error_ = std::current_exception();
+  }
+}
+
+}//namespace PolyTriang
@@ -0,0 +1,204 @@
+#include "arena.hh"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace Topo {
+
+namespace {
+
+thread_local Arena* curr_arena = nullptr;
+
+const size_t SLAB_SIZE = size_t(1) << 16;
+
+// The pools are locked only for a few instructions: a spin lock is cheaper
+// than a mutex.
+struct SpinLock
+{
+  void lock()
+  {
+    while (flag_.test_and_set(std::memory_order_acquire))
+      std::this_thread::yield();
+  }
+  void unlock() { flag_.clear(std::memory_order_release); }
+private:
+  std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+};
+
+}//namespace
+
+// Blocks of one size: the free ones are linked through their first word.
+struct Arena::Pool
+{
+  Pool(size_t _size) : size_(_size) {}
+
+  ~Pool()
+  {
+    for (auto slab : slabs_)
+      ::operator delete(slab);
+  }
+
+  void* allocate()
+  {
+#ifdef TOPO_THREAD_SAFE
+    std::lock_guard<SpinLock> lock(lock_);
+#endif
+    if (free_ == nullptr)
+      grow();
+    auto block = free_;
+    free_ = *static_cast<void**>(free_);
+    ++live_;
+    return block;
+  }
+
+  void deallocate(void* _block)
+  {
+    bool last;
+    {
+#ifdef TOPO_THREAD_SAFE
+      std::lock_guard<SpinLock> lock(lock_);
+#endif
+      *static_cast<void**>(_block) = free_;
+      free_ = _block;
+      last = --live_ == 0 && orphan_;
+    }
+    if (last)
+      delete this;
+  }
+
+  // Called by the destructor of the arena: false if no block is in use,
+  // else the pool deletes itself with its last block.
+  bool orphan()
+  {
+#ifdef TOPO_THREAD_SAFE
+    std::lock_guard<SpinLock> lock(lock_);
+#endif
+    orphan_ = live_ > 0;
+    return orphan_;
+  }
+
+  // New slabs for _count blocks, in front of the free ones.
+  void reserve(size_t _count)
+  {
+#ifdef TOPO_THREAD_SAFE
+    std::lock_guard<SpinLock> lock(lock_);
+#endif
+    const auto slab_blocks = SLAB_SIZE / size_;
+    for (size_t n = 0; n < _count; n += slab_blocks)
+      grow();
+  }
+
+  size_t live() const
+  {
+#ifdef TOPO_THREAD_SAFE
+    std::lock_guard<SpinLock> lock(lock_);
+#endif
+    return live_;
+  }
+
+private:
+  void grow()
+  {
+    auto slab = static_cast<char*>(::operator new(SLAB_SIZE));
+    slabs_.push_back(slab);
+    for (size_t pos = SLAB_SIZE / size_ * size_; pos > 0;)
+    {
+      pos -= size_;
+      *reinterpret_cast<void**>(slab + pos) = free_;
+      free_ = slab + pos;
+    }
+  }
+
+  const size_t size_;
+  void* free_ = nullptr;
+  size_t live_ = 0;
+  bool orphan_ = false;
+  std::vector<char*> slabs_;
+#ifdef TOPO_THREAD_SAFE
+  mutable SpinLock lock_;
+#endif
+};
+
+Arena::Arena()
+{
+  static_assert(HEADER >= sizeof(Pool*), "The header holds the pool");
+  for (size_t i = 0; i < pools_.size(); ++i)
+    pools_[i].reset(new Pool((i + 1) * GRAIN));
+}
+
+Arena::~Arena()
+{
+  for (auto& pool : pools_)
+  {
+    if (pool->orphan())
+      pool.release();
+  }
+}
+
+void* Arena::allocate(std::size_t _size)
+{
+  const auto size = HEADER + _size;
+  Pool* pool = nullptr;
+  void* block;
+  if (size <= MAX_SIZE)
+  {
+    pool = pools_[(size - 1) / GRAIN].get();
+    block = pool->allocate();
+  }
+  else
+    block = ::operator new(size);
+  *static_cast<Pool**>(block) = pool;
+  return static_cast<char*>(block) + HEADER;
+}
+
+void Arena::reserve(std::size_t _size, size_t _count)
+{
+  const auto size = HEADER + _size;
+  if (size <= MAX_SIZE && _count > 0)
+    pools_[(size - 1) / GRAIN]->reserve(_count);
+}
+
+void Arena::deallocate(void* _ptr)
+{
+  if (_ptr == nullptr)
+    return;
+  auto block = reinterpret_cast<Pool**>(static_cast<char*>(_ptr) - HEADER);
+  if (*block == nullptr)
+    ::operator delete(block);
+  else
+    (*block)->deallocate(block);
+}
+
+size_t Arena::live() const
+{
+  size_t live = 0;
+  for (const auto& pool : pools_)
+    live += pool->live();
+  return live;
+}
+
+Arena& Arena::current()
+{
+  return curr_arena == nullptr ? global() : *curr_arena;
+}
+
+Arena& Arena::global()
+{
+  // Never destroyed: static wraps can release objects at exit.
+  static Arena* arena = new Arena;
+  return *arena;
+}
+
+ArenaScope::ArenaScope(Arena& _arena) : prev_(curr_arena)
+{
+  curr_arena = &_arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+  curr_arena = prev_;
+}
+
+}//namespace Topo
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Topo {
+
+// Memory of the topology objects. Every object size (in practice every
+// SubType) has its own pool of blocks cut from big slabs, and a deleted
+// object gives its block back to the pool it comes from. Each block starts
+// with a pointer to its pool, so a block can be freed while any arena is
+// current. Blocks and headers are aligned as the global operator new. A
+// block can be freed on any thread only with TOPO_THREAD_SAFE, otherwise
+// on the thread that uses its arena.
+class Arena
+{
+public:
+  Arena();
+  // The pools without objects in use are freed at once. The others live
+  // until their last object is deleted.
+  ~Arena();
+
+  void* allocate(std::size_t _size);
+  static void deallocate(void* _ptr);
+  // The next _count objects of _size are allocated in new slabs, one after
+  // the other, e.g. the vertices of a body made in the order of its
+  // traversals.
+  void reserve(std::size_t _size, size_t _count);
+
+  // Number of blocks in use.
+  size_t live() const;
+
+  // The arena used by new objects on this thread: the global one, unless
+  // an ArenaScope is active.
+  static Arena& current();
+  static Arena& global();
+
+private:
+  struct Pool;
+  // The header, a pointer to the pool, padded to keep the object aligned.
+  static const size_t HEADER = alignof(std::max_align_t);
+  static const size_t GRAIN = alignof(std::max_align_t);
+  static const size_t MAX_SIZE = 512;
+  std::array<std::unique_ptr<Pool>, MAX_SIZE / GRAIN> pools_;
+};
+
+// While it exists, the objects made on this thread go in _arena, e.g. the
+// temporary objects of a boolean operation, freed together at the end.
+struct ArenaScope
+{
+  ArenaScope(Arena& _arena);
+  ~ArenaScope();
+private:
+  Arena* prev_;
+};
+
+}//namespace Topo
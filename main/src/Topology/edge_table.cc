@@ -0,0 +1,102 @@
+#include "edge_table.hh"
+#include "impl.hh"
+
+namespace Topo {
+
+EdgeTable::Key EdgeTable::key(const IBase* _v0, const IBase* _v1)
+{
+  return _v1->id() < _v0->id() ? Key(_v1, _v0) : Key(_v0, _v1);
+}
+
+void EdgeTable::add_face(const IBase* _face)
+{
+  // The new sides are counted before the old ones are dropped: the edges
+  // the face keeps never reach 0 uses and keep their EdgeRef.
+  std::vector<Key> keys;
+  const auto n = _face->size(Direction::Down);
+  if (n >= 2)
+  {
+    keys.reserve(n);
+    auto prev = _face->get(Direction::Down, n - 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+      auto vert = _face->get(Direction::Down, i);
+      keys.push_back(key(prev, vert));
+      prev = vert;
+    }
+  }
+  for (const auto& k : keys)
+  {
+    auto it = edges_.find(k);
+    if (it != edges_.end())
+    {
+      ++it->second.uses_;
+      continue;
+    }
+    Wrap<Type::EDGE> edge;
+    auto edref = edge.make<EdgeRef>();
+    edref->verts_[0].reset(static_cast<E<Type::VERTEX>*>(const_cast<IBase*>(k.first)));
+    edref->verts_[1].reset(static_cast<E<Type::VERTEX>*>(const_cast<IBase*>(k.second)));
+    edges_.emplace(k, Record{ edge, 1 });
+  }
+  remove_face(_face);
+  if (!keys.empty())
+    face_keys_.emplace(_face, std::move(keys));
+}
+
+void EdgeTable::remove_face(const IBase* _face)
+{
+  auto it = face_keys_.find(_face);
+  if (it == face_keys_.end())
+    return;
+  for (const auto& k : it->second)
+  {
+    auto edge_it = edges_.find(k);
+    if (--edge_it->second.uses_ == 0)
+      edges_.erase(k);
+  }
+  face_keys_.erase(_face);
+}
+
+E<Type::EDGE>* EdgeTable::find(const IBase* _v0, const IBase* _v1) const
+{
+  auto it = edges_.find(key(_v0, _v1));
+  if (it == edges_.end())
+    return nullptr;
+  return const_cast<E<Type::EDGE>*>(it->second.edge_.get());
+}
+
+bool add_edge_table(Wrap<Type::BODY>& _body)
+{
+  if (_body->sub_type() != SubType::BODY)
+    return false;
+  auto body = static_cast<EE<Type::BODY>*>(_body.get());
+  body->edge_table_.reset(new EdgeTable);
+  for (size_t i = 0; i < body->size(Direction::Down); ++i)
+    body->edge_table_->add_face(body->get(Direction::Down, i));
+  return true;
+}
+
+void remove_edge_table(Wrap<Type::BODY>& _body)
+{
+  if (_body->sub_type() == SubType::BODY)
+    static_cast<EE<Type::BODY>*>(_body.get())->edge_table_.reset();
+}
+
+bool has_edge_table(const Wrap<Type::BODY>& _body)
+{
+  return _body->sub_type() == SubType::BODY &&
+    static_cast<const EE<Type::BODY>*>(_body.get())->edge_table_ != nullptr;
+}
+
+const EdgeTable* edge_table(const IBase* _face)
+{
+  if (_face->type() != Type::FACE || _face->size(Direction::Up) != 1)
+    return nullptr;
+  auto body = _face->get(Direction::Up, 0);
+  if (body->sub_type() != SubType::BODY)
+    return nullptr;
+  return static_cast<const EE<Type::BODY>*>(body)->edge_table_.get();
+}
+
+}//namespace Topo
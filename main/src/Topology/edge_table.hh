@@ -0,0 +1,58 @@
+#pragma once
+
+#include "topology.hh"
+#include "Utils/flat_hash.hh"
+
+#include <vector>
+
+namespace Topo {
+
+// Adds to the body a table of its edges, the couples of vertices next to
+// each other in a face, each one with an EdgeRef made once. The iterators
+// on the edges of the body, of its faces and of its vertices give these
+// EdgeRefs, so an edge is the same object in all the queries, and the
+// edits of the body and of its faces (insert_child, remove_child,
+// replace_child, Split, replace) keep the table up to date.
+bool add_edge_table(Wrap<Type::BODY>& _body);
+void remove_edge_table(Wrap<Type::BODY>& _body);
+bool has_edge_table(const Wrap<Type::BODY>& _body);
+
+struct EdgeTable
+{
+  // Indexes the face again: its previous edges are dropped.
+  void add_face(const IBase* _face);
+  void remove_face(const IBase* _face);
+
+  // The edge on the two vertices, null if they are not in the table.
+  E<Type::EDGE>* find(const IBase* _v0, const IBase* _v1) const;
+
+  // The edges, in an array without holes.
+  size_t size() const { return edges_.size(); }
+  const Wrap<Type::EDGE>& edge(size_t _i) const { return edges_.begin()[_i].second.edge_; }
+
+private:
+  // The vertices sorted as in EdgeRef::finalise.
+  typedef std::pair<const IBase*, const IBase*> Key;
+  static Key key(const IBase* _v0, const IBase* _v1);
+  struct KeyHash
+  {
+    size_t operator()(const Key& _key) const
+    {
+      return Utils::hash_combine(
+        std::hash<const IBase*>()(_key.first), std::hash<const IBase*>()(_key.second));
+    }
+  };
+  struct Record
+  {
+    Wrap<Type::EDGE> edge_;
+    size_t uses_; // Number of face sides on the edge.
+  };
+
+  Utils::FlatHashMap<Key, Record, KeyHash> edges_;
+  Utils::FlatHashMap<const IBase*, std::vector<Key>> face_keys_;
+};
+
+// The table of the body of the face, if it has one.
+const EdgeTable* edge_table(const IBase* _face);
+
+}//namespace Topo
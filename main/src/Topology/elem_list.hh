@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Utils/flat_hash.hh"
+#include "Utils/small_vector.hh"
+
+#include <algorithm>
+#include <memory>
+
+namespace Topo {
+
+struct IBase;
+
+// Parents or children of an element. The first N are inline in the
+// element. From INDEX_SIZE elements on (e.g. the faces of a body, or of
+// the apex of a big fan) a hash index gives the position of every element,
+// so find and remove do not scan the list.
+template <size_t N> class ElemList
+{
+  typedef Utils::SmallVector<IBase*, N> Elements;
+
+public:
+  static const size_t INDEX_SIZE = 32;
+
+  typedef typename Elements::const_iterator const_iterator;
+  typedef typename Elements::const_reverse_iterator const_reverse_iterator;
+
+  ElemList() {}
+  ElemList(const ElemList&) = delete;
+  ElemList& operator=(const ElemList&) = delete;
+
+  size_t size() const { return elems_.size(); }
+  bool empty() const { return elems_.empty(); }
+  IBase* operator[](size_t _i) const { return elems_[_i]; }
+  const_iterator begin() const { return elems_.begin(); }
+  const_iterator end() const { return elems_.end(); }
+
+  void insert(size_t _pos, IBase* _el)
+  {
+    if (_pos > elems_.size())
+      _pos = elems_.size();
+    elems_.insert(elems_.begin() + _pos, _el);
+    if (index_)
+    {
+      if (_pos + 1 < elems_.size())
+      {
+        for (auto& entry : *index_)
+        {
+          if (entry.second.pos_ >= _pos)
+            ++entry.second.pos_;
+        }
+      }
+      add_to_index(_el, _pos);
+    }
+    else if (elems_.size() >= INDEX_SIZE)
+      make_index();
+  }
+
+  void push_back(IBase* _el) { insert(SIZE_MAX, _el); }
+
+  void erase(size_t _pos)
+  {
+    auto el = elems_[_pos];
+    elems_.erase(elems_.begin() + _pos);
+    if (!index_)
+      return;
+    if (elems_.size() < INDEX_SIZE / 2)
+    {
+      index_.reset();
+      return;
+    }
+    for (auto& entry : *index_)
+    {
+      if (entry.second.pos_ > _pos)
+        --entry.second.pos_;
+    }
+    remove_from_index(el);
+  }
+
+  void set(size_t _pos, IBase* _el)
+  {
+    auto old_el = elems_[_pos];
+    if (old_el == _el)
+      return;
+    elems_[_pos] = _el;
+    if (index_)
+    {
+      remove_from_index(old_el);
+      add_to_index(_el, _pos);
+    }
+  }
+
+  // Sets all the elements, the index is made again.
+  template <class IteratorT> void assign(IteratorT _beg, IteratorT _end)
+  {
+    elems_.assign(_beg, _end);
+    if (elems_.size() >= INDEX_SIZE)
+      make_index();
+    else
+      index_.reset();
+  }
+
+  void reverse()
+  {
+    std::reverse(elems_.begin(), elems_.end());
+    if (index_)
+      make_index();
+  }
+
+  // First position of _el, SIZE_MAX if missing.
+  size_t find_first(const IBase* _el) const
+  {
+    if (index_)
+    {
+      auto entry = find_entry(_el);
+      if (entry == nullptr)
+        return SIZE_MAX;
+      if (entry->count_ == 1)
+        return entry->pos_;
+    }
+    auto it = std::find(elems_.begin(), elems_.end(), _el);
+    return it == elems_.end() ? SIZE_MAX : it - elems_.begin();
+  }
+
+  // Last position of _el before _end, SIZE_MAX if missing.
+  size_t find_last(const IBase* _el, size_t _end = SIZE_MAX) const
+  {
+    if (_end > elems_.size())
+      _end = elems_.size();
+    if (index_)
+    {
+      auto entry = find_entry(_el);
+      if (entry == nullptr)
+        return SIZE_MAX;
+      if (entry->count_ == 1)
+        return entry->pos_ < _end ? entry->pos_ : SIZE_MAX;
+    }
+    auto beg = elems_.rbegin() + (elems_.size() - _end);
+    auto it = std::find(beg, elems_.rend(), _el);
+    return it == elems_.rend() ? SIZE_MAX : elems_.rend() - it - 1;
+  }
+
+private:
+  // The position is valid for the elements that are in the list once. The
+  // repeated ones, e.g. the vertex of a face that touches itself, are
+  // searched in the list.
+  struct Entry
+  {
+    size_t pos_;
+    size_t count_;
+  };
+  typedef Utils::FlatHashMap<const IBase*, Entry> Index;
+
+  const Entry* find_entry(const IBase* _el) const
+  {
+    auto it = index_->find(_el);
+    return it == index_->end() ? nullptr : &it->second;
+  }
+
+  void add_to_index(IBase* _el, size_t _pos)
+  {
+    auto ins = index_->emplace(_el, Entry{ _pos, 1 });
+    if (!ins.second)
+      ++ins.first->second.count_;
+  }
+
+  void remove_from_index(IBase* _el)
+  {
+    auto it = index_->find(_el);
+    if (--it->second.count_ == 0)
+      index_->erase(_el);
+    else if (it->second.count_ == 1)
+      it->second.pos_ = std::find(elems_.begin(), elems_.end(), _el) - elems_.begin();
+  }
+
+  void make_index()
+  {
+    index_.reset(new Index);
+    index_->reserve(elems_.size());
+    for (size_t i = 0; i < elems_.size(); ++i)
+      add_to_index(elems_[i], i);
+  }
+
+  Elements elems_;
+  std::unique_ptr<Index> index_;
+};
+
+}//namespace Topo
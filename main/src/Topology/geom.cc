@@ -1,14 +1,13 @@
 
 #include "geom.hh"
-#include "iterator.hh"
+#include "view.hh"
 
 namespace Topo {
 
 Geo::Point face_normal(Topo::Wrap<Topo::Type::FACE> _face)
 {
-  Iterator<Type::FACE, Type::VERTEX> fv_it(_face);
   std::vector<Geo::Point> verts;
-  for (auto vert : fv_it)
+  for (auto vert : View<Type::FACE, Type::VERTEX>(_face))
   {
     verts.emplace_back();
     vert->geom(verts.back());
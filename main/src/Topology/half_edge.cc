@@ -0,0 +1,172 @@
+#include "half_edge.hh"
+#include "impl.hh"
+
+#include <algorithm>
+
+namespace Topo {
+
+void HalfEdgeIndex::add_face(const IBase* _face)
+{
+  remove_face(_face);
+  const auto n = _face->size(Direction::Down);
+  if (n == 0)
+    return;
+  std::vector<size_t> ring(n);
+  for (auto& he : ring)
+  {
+    if (free_.empty())
+    {
+      he = hes_.size();
+      hes_.emplace_back();
+    }
+    else
+    {
+      he = free_.back();
+      free_.pop_back();
+    }
+  }
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto& he = hes_[ring[i]];
+    he.face_ = _face;
+    he.vert_ = _face->get(Direction::Down, i);
+    he.pos_ = i;
+    he.next_ = ring[i + 1 < n ? i + 1 : 0];
+    he.prev_ = ring[i > 0 ? i - 1 : n - 1];
+    he.twin_ = INVALID;
+    vert_out_[he.vert_].push_back(ring[i]);
+  }
+  for (auto he : ring)
+  {
+    by_verts_.emplace(Key(hes_[he].vert_, end_vertex(he)), he);
+    link_twin(he);
+  }
+  face_first_[_face] = ring[0];
+}
+
+void HalfEdgeIndex::remove_face(const IBase* _face)
+{
+  auto it = face_first_.find(_face);
+  if (it == face_first_.end())
+    return;
+  std::vector<size_t> ring(1, it->second);
+  while (hes_[ring.back()].next_ != ring[0])
+    ring.push_back(hes_[ring.back()].next_);
+  face_first_.erase(it);
+
+  for (auto he : ring)
+  {
+    auto rng = by_verts_.equal_range(Key(hes_[he].vert_, end_vertex(he)));
+    for (auto by_it = rng.first; by_it != rng.second; ++by_it)
+    {
+      if (by_it->second == he)
+      {
+        by_verts_.erase(by_it);
+        break;
+      }
+    }
+  }
+  for (auto he : ring)
+  {
+    unlink_twin(he);
+    auto out_it = vert_out_.find(hes_[he].vert_);
+    auto& out = out_it->second;
+    out.erase(std::find(out.begin(), out.end(), he));
+    if (out.empty())
+      vert_out_.erase(out_it);
+    hes_[he].face_ = nullptr;
+    free_.push_back(he);
+  }
+}
+
+const std::vector<size_t>& HalfEdgeIndex::outgoing(const IBase* _vert) const
+{
+  static const std::vector<size_t> none;
+  auto it = vert_out_.find(_vert);
+  return it == vert_out_.end() ? none : it->second;
+}
+
+void HalfEdgeIndex::find(const IBase* _v0, const IBase* _v1,
+  std::vector<size_t>& _hes) const
+{
+  _hes.clear();
+  auto rng = by_verts_.equal_range(Key(_v0, _v1));
+  for (auto it = rng.first; it != rng.second; ++it)
+    _hes.push_back(it->second);
+  std::sort(_hes.begin(), _hes.end());
+}
+
+// Pairs _he with a reversed half-edge that has no twin yet.
+void HalfEdgeIndex::link_twin(size_t _he)
+{
+  auto rng = by_verts_.equal_range(Key(end_vertex(_he), hes_[_he].vert_));
+  for (auto it = rng.first; it != rng.second; ++it)
+  {
+    if (it->second != _he && hes_[it->second].twin_ == INVALID)
+    {
+      hes_[_he].twin_ = it->second;
+      hes_[it->second].twin_ = _he;
+      return;
+    }
+  }
+}
+
+// The twin of _he, if any, looks for another one. _he must be out of
+// by_verts_.
+void HalfEdgeIndex::unlink_twin(size_t _he)
+{
+  const auto twin = hes_[_he].twin_;
+  if (twin == INVALID)
+    return;
+  hes_[_he].twin_ = INVALID;
+  hes_[twin].twin_ = INVALID;
+  if (hes_[twin].face_ != nullptr && face_first_.count(hes_[twin].face_) > 0)
+    link_twin(twin);
+}
+
+bool add_half_edge_index(Wrap<Type::BODY>& _body)
+{
+  if (_body->sub_type() != SubType::BODY)
+    return false;
+  auto body = static_cast<EE<Type::BODY>*>(_body.get());
+  body->half_edges_.reset(new HalfEdgeIndex);
+  for (size_t i = 0; i < body->size(Direction::Down); ++i)
+    body->half_edges_->add_face(body->get(Direction::Down, i));
+  return true;
+}
+
+void remove_half_edge_index(Wrap<Type::BODY>& _body)
+{
+  if (_body->sub_type() == SubType::BODY)
+    static_cast<EE<Type::BODY>*>(_body.get())->half_edges_.reset();
+}
+
+bool has_half_edge_index(const Wrap<Type::BODY>& _body)
+{
+  return _body->sub_type() == SubType::BODY &&
+    static_cast<const EE<Type::BODY>*>(_body.get())->half_edges_ != nullptr;
+}
+
+const HalfEdgeIndex* half_edge_index(const IBase* _vert)
+{
+  const auto face_nmbr = _vert->size(Direction::Up);
+  if (face_nmbr == 0 || face_nmbr == SIZE_MAX)
+    return nullptr;
+  const HalfEdgeIndex* index = nullptr;
+  for (size_t i = 0; i < face_nmbr; ++i)
+  {
+    auto face = _vert->get(Direction::Up, i);
+    if (face->type() != Type::FACE || face->size(Direction::Up) != 1)
+      return nullptr;
+    auto body = face->get(Direction::Up, 0);
+    if (body->sub_type() != SubType::BODY)
+      return nullptr;
+    auto body_index = static_cast<const EE<Type::BODY>*>(body)->half_edges_.get();
+    if (body_index == nullptr || (index != nullptr && body_index != index))
+      return nullptr;
+    index = body_index;
+  }
+  return index;
+}
+
+}//namespace Topo
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "topology.hh"
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Topo {
+
+// Adds to the body an index of the half-edges of its faces. The iterators
+// from vertices and edges use it for the adjacency, instead of intersecting
+// the faces of the vertices, and the edits of the body and of its faces
+// (insert_child, remove_child, replace_child, reverse, Split) keep it up to
+// date. It is used only when all the faces of a vertex are in the body.
+bool add_half_edge_index(Wrap<Type::BODY>& _body);
+void remove_half_edge_index(Wrap<Type::BODY>& _body);
+bool has_half_edge_index(const Wrap<Type::BODY>& _body);
+
+// Half-edges of the faces of a body. A face of n vertices has a ring of n
+// half-edges, one from each vertex to the next one.
+struct HalfEdgeIndex
+{
+  static const size_t INVALID = SIZE_MAX;
+
+  struct HalfEdge
+  {
+    const IBase* face_;
+    const IBase* vert_; // Start vertex.
+    size_t pos_;        // Position of vert_ in the face.
+    size_t next_, prev_;
+    size_t twin_;       // A half-edge on the same vertices, reversed.
+  };
+
+  const HalfEdge& operator[](size_t _he) const { return hes_[_he]; }
+  const IBase* end_vertex(size_t _he) const { return hes_[hes_[_he].next_].vert_; }
+
+  // Indexes the face again: all its previous half-edges are dropped.
+  void add_face(const IBase* _face);
+  void remove_face(const IBase* _face);
+
+  // Half-edges starting at _vert.
+  const std::vector<size_t>& outgoing(const IBase* _vert) const;
+  // Half-edges from _v0 to _v1.
+  void find(const IBase* _v0, const IBase* _v1, std::vector<size_t>& _hes) const;
+
+  size_t size() const { return hes_.size() - free_.size(); }
+
+private:
+  typedef std::pair<const IBase*, const IBase*> Key;
+  struct KeyHash
+  {
+    size_t operator()(const Key& _key) const
+    {
+      const auto h0 = std::hash<const IBase*>()(_key.first);
+      return h0 ^ (std::hash<const IBase*>()(_key.second) + 0x9e3779b9 + (h0 << 6) + (h0 >> 2));
+    }
+  };
+
+  void link_twin(size_t _he);
+  void unlink_twin(size_t _he);
+
+  std::vector<HalfEdge> hes_;
+  std::vector<size_t> free_;
+  std::unordered_map<const IBase*, size_t> face_first_;
+  std::unordered_map<const IBase*, std::vector<size_t>> vert_out_;
+  std::unordered_multimap<Key, size_t, KeyHash> by_verts_;
+};
+
+// The index of the only body of the faces around _vert, if it has one.
+const HalfEdgeIndex* half_edge_index(const IBase* _vert);
+
+}//namespace Topo
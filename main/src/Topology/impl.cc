@@ -1,12 +1,127 @@
 
 #include "impl.hh"
+#include "edge_table.hh"
+#include "half_edge.hh"
 #include "persistence.hh"
 #include <Utils/error_handling.hh>
+#include <Utils/flat_hash.hh>
 #include <Utils/statistics.hh>
 #include <Geo/vector.hh>
 
 namespace Topo {
 
+EE<Type::BODY>::EE() {}
+EE<Type::BODY>::~EE() {}
+
+bool EE<Type::BODY>::insert_child(IBase* _el, size_t _pos)
+{
+  if (!UpEntity<Type::BODY>::insert_child(_el, _pos))
+    return false;
+  if (half_edges_)
+    half_edges_->add_face(_el);
+  if (edge_table_)
+    edge_table_->add_face(_el);
+  return true;
+}
+
+bool EE<Type::BODY>::remove_child(size_t _pos)
+{
+  if (half_edges_ && _pos < low_elems_.size())
+    half_edges_->remove_face(low_elems_[_pos]);
+  if (edge_table_ && _pos < low_elems_.size())
+    edge_table_->remove_face(low_elems_[_pos]);
+  return UpEntity<Type::BODY>::remove_child(_pos);
+}
+
+bool EE<Type::BODY>::replace_child(IBase* _el, IBase* _new_el)
+{
+  if (!UpEntity<Type::BODY>::replace_child(_el, _new_el))
+    return false;
+  if (half_edges_)
+  {
+    half_edges_->remove_face(_el);
+    half_edges_->add_face(_new_el);
+  }
+  if (edge_table_)
+  {
+    edge_table_->remove_face(_el);
+    edge_table_->add_face(_new_el);
+  }
+  return true;
+}
+
+bool EE<Type::BODY>::set_children(const std::vector<IBase*>& _els)
+{
+  std::vector<IBase*> added, removed;
+  if (!assign_children(_els, &added, removed))
+    return false;
+  for (auto face : removed)
+  {
+    if (half_edges_)
+      half_edges_->remove_face(face);
+    if (edge_table_)
+      edge_table_->remove_face(face);
+    face->release_ref();
+  }
+  for (auto face : added)
+  {
+    if (half_edges_)
+      half_edges_->add_face(face);
+    if (edge_table_)
+      edge_table_->add_face(face);
+  }
+  return true;
+}
+
+bool EE<Type::FACE>::insert_child(IBase* _el, size_t _pos)
+{
+  if (!UpEntity<Type::FACE>::insert_child(_el, _pos))
+    return false;
+  update_bodies();
+  return true;
+}
+
+bool EE<Type::FACE>::remove_child(size_t _pos)
+{
+  if (!UpEntity<Type::FACE>::remove_child(_pos))
+    return false;
+  update_bodies();
+  return true;
+}
+
+bool EE<Type::FACE>::replace_child(IBase* _el, IBase* _new_el)
+{
+  if (!UpEntity<Type::FACE>::replace_child(_el, _new_el))
+    return false;
+  update_bodies();
+  return true;
+}
+
+bool EE<Type::FACE>::set_children(const std::vector<IBase*>& _els)
+{
+  std::vector<IBase*> removed;
+  if (!assign_children(_els, nullptr, removed))
+    return false;
+  update_bodies();
+  for (auto vert : removed)
+    vert->release_ref();
+  return true;
+}
+
+void EE<Type::FACE>::update_bodies() const
+{
+  for (auto prnt : up_elems_)
+  {
+    if (prnt->sub_type() != SubType::BODY)
+      continue;
+    auto body = static_cast<const EE<Type::BODY>*>(prnt);
+    if (body->half_edges_)
+      body->half_edges_->add_face(this);
+    if (body->edge_table_)
+      body->edge_table_->add_face(this);
+  }
+}
+
 bool EE<Type::EDGE>::geom(Geo::Segment& /*_seg*/) const
 {
   return false;
@@ -31,7 +146,7 @@ bool EdgeRef::operator<(const Object& _oth) const
 {
   if (_oth.sub_type() != SubType::EDGE_REF)
     return E<Type::EDGE>::operator<(_oth);
-  auto oth = static_cast<const EdgeRef&>(_oth);
+  const auto& oth = static_cast<const EdgeRef&>(_oth);
   return verts_[0] < oth.verts_[0] ||
     (verts_[0] == oth.verts_[0] && verts_[1] < oth.verts_[1]);
 }
@@ -40,10 +155,16 @@ bool EdgeRef::operator==(const Object& _oth) const
 {
   if (_oth.sub_type() != SubType::EDGE_REF)
     return E<Type::EDGE>::operator==(_oth);
-  auto oth = static_cast<const EdgeRef&>(_oth);
+  const auto& oth = static_cast<const EdgeRef&>(_oth);
   return verts_[0] == oth.verts_[0] && verts_[1] == oth.verts_[1];
 }
 
+size_t EdgeRef::hash() const
+{
+  return Utils::hash_combine(
+    std::hash<Wrap<Type::VERTEX>>()(verts_[0]), std::hash<Wrap<Type::VERTEX>>()(verts_[1]));
+}
+
 void EdgeRef::finalise()
 {
   if (verts_[1] < verts_[0])
@@ -89,7 +210,7 @@ bool CoEdgeRef::operator<(const Object& _oth) const
 {
   if (_oth.sub_type() != SubType::COEDGE_REF)
     return E<Type::COEDGE>::operator<(_oth);
-  auto oth = static_cast<const CoEdgeRef&>(_oth);
+  const auto& oth = static_cast<const CoEdgeRef&>(_oth);
   return face_ < oth.face_ || face_ == oth.face_ && ind_ < oth.ind_;
 }
 
@@ -97,10 +218,15 @@ bool CoEdgeRef::operator==(const Object& _oth) const
 {
   if (_oth.sub_type() != SubType::COEDGE_REF)
     return false;
-  auto oth = static_cast<const CoEdgeRef&>(_oth);
+  const auto& oth = static_cast<const CoEdgeRef&>(_oth);
   return face_ == oth.face_ && ind_ == oth.ind_;
 }
 
+size_t CoEdgeRef::hash() const
+{
+  return Utils::hash_combine(std::hash<Wrap<Type::FACE>>()(face_), ind_);
+}
+
 template<Type typeT>
 void save_base_entity(std::ostream& _ostr, const Base<typeT>* _base_ent, ISaver* _psav)
 {
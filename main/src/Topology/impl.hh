@@ -1,7 +1,13 @@
 #pragma once
 
 #include "Topology.hh"
+#include "elem_list.hh"
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace Topo {
@@ -28,7 +34,7 @@ template <Type typeT> struct Base : public E<typeT>
 
   virtual bool replace(IBase* _new_elem)
   {
-    auto up_elems = up_elems_;
+    std::vector<IBase*> up_elems(up_elems_.begin(), up_elems_.end());
     for (const auto& prnt : up_elems)
       prnt->replace_child(this, _new_elem);
     return true;
@@ -36,7 +42,7 @@ template <Type typeT> struct Base : public E<typeT>
 
   virtual bool remove()
   {
-    auto up_elems = up_elems_;
+    std::vector<IBase*> up_elems(up_elems_.begin(), up_elems_.end());
     for (const auto& prnt : up_elems)
       prnt->remove_child(this);
     return true;
@@ -44,25 +50,24 @@ template <Type typeT> struct Base : public E<typeT>
 
   virtual size_t find_parent(const IBase* _prnt) const
   {
-    auto it = std::find(up_elems_.begin(), up_elems_.end(), _prnt);
-    if (it == up_elems_.end())
-      return SIZE_MAX;
-    return it - up_elems_.begin();
+    return up_elems_.find_first(_prnt);
   }
 
 protected:
   virtual bool remove_parent(IBase* _prnt)
   {
-    auto it = std::find(up_elems_.begin(), up_elems_.end(), _prnt);
-    if (it == up_elems_.end())
+    auto pos = up_elems_.find_first(_prnt);
+    if (pos == SIZE_MAX)
       return false;
-    up_elems_.erase(it);
+    up_elems_.erase(pos);
     return true;
   }
 
   bool add_parent(IBase* _prnt) { up_elems_.push_back(_prnt); return true; }
 
-  std::vector<IBase*> up_elems_;
+  // Most vertices have less than 8 faces around, the other elements have
+  // one or two parents.
+  ElemList<typeT == Type::VERTEX ? 6 : 2> up_elems_;
 };
 
 template <Type typeT> struct UpEntity : public Base<typeT>
@@ -90,8 +95,7 @@ template <Type typeT> struct UpEntity : public Base<typeT>
   {
     if (_el == nullptr)
       return false;
-    auto it = (_pos >= low_elems_.size()) ? low_elems_.end() : low_elems_.begin() + _pos;
-    low_elems_.insert(it, _el);
+    low_elems_.insert(_pos, _el);
     _el->add_ref();
     _el->add_parent(this);
     return true;
@@ -102,7 +106,7 @@ template <Type typeT> struct UpEntity : public Base<typeT>
     if (_pos >= low_elems_.size())
       return false;
     auto obj = low_elems_[_pos];
-    low_elems_.erase(low_elems_.begin() + _pos);
+    low_elems_.erase(_pos);
     obj->remove_parent(this);
     obj->release_ref();
     return true;
@@ -110,10 +114,10 @@ template <Type typeT> struct UpEntity : public Base<typeT>
 
   virtual bool remove_child(IBase* _el)
   {
-    auto it = std::find(low_elems_.begin(), low_elems_.end(), _el);
-    if (it == low_elems_.end())
+    auto pos = low_elems_.find_first(_el);
+    if (pos == SIZE_MAX)
       return false;
-    return remove_child(it - low_elems_.begin());
+    return remove_child(pos);
   }
 
   bool replace_child(size_t _pos, IBase* _new_obj)
@@ -128,7 +132,7 @@ template <Type typeT> struct UpEntity : public Base<typeT>
     low_elems_[_pos]->remove_parent(this);
     low_elems_[_pos]->release_ref();
 
-    low_elems_[_pos] = _new_obj;
+    low_elems_.set(_pos, _new_obj);
     _new_obj->add_parent(this);
     return true;
   }
@@ -144,13 +148,7 @@ template <Type typeT> struct UpEntity : public Base<typeT>
   // search for an element in the range [0, _end[ in reverse order.
   virtual size_t find_child(const IBase* _el, size_t _end = SIZE_MAX) const
   {
-    auto start_it = low_elems_.rbegin();
-    if (_end < low_elems_.size())
-      start_it += low_elems_.size() - _end;
-    auto it = std::find(start_it, low_elems_.rend(), _el);
-    if (it == low_elems_.rend())
-      return SIZE_MAX;
-    return low_elems_.rend() - it - 1;
+    return low_elems_.find_last(_el, _end);
   }
 
   virtual bool remove()
@@ -160,15 +158,72 @@ template <Type typeT> struct UpEntity : public Base<typeT>
     return Base<typeT>::remove();
   }
 
+  virtual bool set_children(const std::vector<IBase*>& _els)
+  {
+    std::vector<IBase*> removed;
+    if (!assign_children(_els, nullptr, removed))
+      return false;
+    for (auto el : removed)
+      el->release_ref();
+    return true;
+  }
+
 protected:
-  std::vector<IBase*> low_elems_;
+  // Only the children that join or leave the list update their parents.
+  // The ones that leave are still referenced: the caller releases them.
+  bool assign_children(const std::vector<IBase*>& _els,
+    std::vector<IBase*>* _added, std::vector<IBase*>& _removed)
+  {
+    if (std::find(_els.begin(), _els.end(), nullptr) != _els.end() ||
+      std::equal(_els.begin(), _els.end(), low_elems_.begin(), low_elems_.end()))
+    {
+      return false;
+    }
+    std::vector<IBase*> old_els(low_elems_.begin(), low_elems_.end());
+    std::vector<IBase*> new_els(_els);
+    std::sort(old_els.begin(), old_els.end());
+    std::sort(new_els.begin(), new_els.end());
+    std::vector<IBase*> added;
+    std::set_difference(new_els.begin(), new_els.end(),
+      old_els.begin(), old_els.end(), std::back_inserter(added));
+    std::set_difference(old_els.begin(), old_els.end(),
+      new_els.begin(), new_els.end(), std::back_inserter(_removed));
+    low_elems_.assign(_els.begin(), _els.end());
+    for (auto el : added)
+    {
+      el->add_ref();
+      el->add_parent(this);
+    }
+    for (auto el : _removed)
+      el->remove_parent(this);
+    if (_added != nullptr)
+      _added->swap(added);
+    return true;
+  }
+
+  // Most faces have 3 or 4 vertices.
+  ElemList<typeT == Type::EDGE ? 2 : 4> low_elems_;
 };
 
 template <Type typeT> struct EE;
 
+struct HalfEdgeIndex;
+struct EdgeTable;
+
 template <> struct EE<Type::BODY> : public UpEntity<Type::BODY>
 {
+  EE();
+  ~EE();
   virtual SubType sub_type() const { return SubType::BODY; }
+  // The edits of the faces update half_edges_ and edge_table_.
+  virtual bool insert_child(IBase* _el, size_t _pos = SIZE_MAX);
+  virtual bool remove_child(size_t _pos);
+  using UpEntity<Type::BODY>::remove_child;
+  virtual bool replace_child(IBase* _el, IBase* _new_el);
+  virtual bool set_children(const std::vector<IBase*>& _els);
+
+  std::unique_ptr<HalfEdgeIndex> half_edges_; // Optional, see half_edge.hh.
+  std::unique_ptr<EdgeTable> edge_table_;     // Optional, see edge_table.hh.
 };
 
 template <> struct EE<Type::FACE> : public UpEntity<Type::FACE>
@@ -176,9 +231,19 @@ template <> struct EE<Type::FACE> : public UpEntity<Type::FACE>
   virtual SubType sub_type() const { return SubType::FACE; }
   virtual bool reverse()
   { 
-    std::reverse(low_elems_.begin(), low_elems_.end());
+    low_elems_.reverse();
+    update_bodies();
     return true; 
   }
+  virtual bool insert_child(IBase* _el, size_t _pos = SIZE_MAX);
+  virtual bool remove_child(size_t _pos);
+  using UpEntity<Type::FACE>::remove_child;
+  virtual bool replace_child(IBase* _el, IBase* _new_el);
+  virtual bool set_children(const std::vector<IBase*>& _els);
+
+private:
+  // Indexes the face again in the HalfEdgeIndex and EdgeTable of its bodies.
+  void update_bodies() const;
 };
 
 template <> struct EE<Type::EDGE> : public UpEntity<Type::EDGE>
@@ -215,6 +280,7 @@ struct EdgeRef : public E<Type::EDGE>
 
   virtual bool operator<(const Object& _oth) const;
   virtual bool operator==(const Object& _oth) const;
+  virtual size_t hash() const;
   void finalise();
   virtual bool operator!=(const EdgeRef& _oth) const { return !(*this == _oth); }
 };
@@ -230,7 +296,97 @@ struct CoEdgeRef : public E<Type::COEDGE>
   virtual bool set_tolerance(const double) { return false; }
   virtual bool operator<(const Object& _oth) const;
   virtual bool operator==(const Object& _oth) const;
+  virtual size_t hash() const;
   virtual bool operator!=(const EdgeRef& _oth) const { return !(*this == _oth); }
 };
 
+// Body of a big mesh in a few flat arrays: the points, their tolerances and
+// the faces as ranges of one array of point indices. There are no vertex
+// and face objects: the iterators make MeshVertex and MeshFace, light
+// references to the body. The body cannot be edited, see expand_mesh_body.
+struct MeshBody : public E<Type::BODY>
+{
+  typedef uint32_t Index;
+
+  virtual SubType sub_type() const { return SubType::MESH_BODY; }
+  virtual size_t size(Direction _dir) const
+  {
+    return _dir == Direction::Down ? face_number() : 0;
+  }
+
+  size_t face_number() const { return face_offs_.empty() ? 0 : face_offs_.size() - 1; }
+  size_t face_size(size_t _f) const { return face_offs_[_f + 1] - face_offs_[_f]; }
+  const Index* face_begin(size_t _f) const { return face_verts_.data() + face_offs_[_f]; }
+  const Index* face_end(size_t _f) const { return face_verts_.data() + face_offs_[_f + 1]; }
+
+  // Faces around the vertex _v, in increasing order. The table is made on
+  // the first request.
+  void vertex_faces(size_t _v, const Index*& _beg, const Index*& _end) const;
+
+  Wrap<Type::VERTEX> vertex(size_t _v) const;
+  Wrap<Type::FACE> face(size_t _f) const;
+
+  std::vector<Geo::Point> pts_;
+  std::vector<double> tols_;
+  std::vector<Index> face_offs_; // Face f is [face_offs_[f], face_offs_[f + 1]).
+  std::vector<Index> face_verts_;
+
+private:
+  void make_vertex_faces() const;
+  mutable std::vector<Index> vert_offs_, vert_faces_;
+  mutable std::once_flag vert_faces_made_;
+};
+
+struct MeshVertex : public E<Type::VERTEX>
+{
+  Wrap<Type::BODY> body_;
+  size_t ind_ = 0;
+
+  virtual SubType sub_type() const { return SubType::MESH_VERTEX; }
+  virtual bool geom(Geo::Point& _pt) const { _pt = mesh().pts_[ind_]; return true; }
+  virtual bool set_geom(const Geo::Point& _pt) { mesh().pts_[ind_] = _pt; return true; }
+  virtual double tolerance() const { return mesh().tols_[ind_]; }
+  virtual bool set_tolerance(const double _tol) { mesh().tols_[ind_] = _tol; return true; }
+
+  virtual size_t size(Direction _dir) const;
+  // The faces are made on the first request, also from many threads, and
+  // kept by the vertex.
+  virtual IBase* get(Direction _dir, size_t _i) const;
+
+  virtual bool operator<(const Object& _oth) const;
+  virtual bool operator==(const Object& _oth) const;
+  virtual size_t hash() const;
+
+  const MeshBody& mesh() const { return static_cast<const MeshBody&>(*body_.get()); }
+  MeshBody& mesh() { return static_cast<MeshBody&>(*body_.get()); }
+
+private:
+  mutable std::vector<Wrap<Type::FACE>> faces_;
+  mutable std::once_flag faces_made_;
+};
+
+struct MeshFace : public E<Type::FACE>
+{
+  Wrap<Type::BODY> body_;
+  size_t ind_ = 0;
+
+  virtual SubType sub_type() const { return SubType::MESH_FACE; }
+  virtual size_t size(Direction _dir) const;
+  // The vertices are made on the first request, also from many threads,
+  // and kept by the face.
+  virtual IBase* get(Direction _dir, size_t _i) const;
+  virtual size_t find_parent(const IBase* _prnt) const;
+  virtual size_t find_child(const IBase* _el, size_t _end = SIZE_MAX) const;
+
+  virtual bool operator<(const Object& _oth) const;
+  virtual bool operator==(const Object& _oth) const;
+  virtual size_t hash() const;
+
+  const MeshBody& mesh() const { return static_cast<const MeshBody&>(*body_.get()); }
+
+private:
+  mutable std::vector<Wrap<Type::VERTEX>> verts_;
+  mutable std::once_flag verts_made_;
+};
+
 }//namespace Topo
@@ -1,13 +1,16 @@
 
+#include "edge_table.hh"
+#include "half_edge.hh"
 #include "impl.hh"
 #include "iterator.hh"
 #include "subtype.hh"
+#include "visit.hh"
 
 #include "Utils/error_handling.hh"
+#include "Utils/flat_hash.hh"
 
-#include <map>
+#include <algorithm>
 #include <vector>
-#include <set>
 
 namespace Topo {
 
@@ -59,6 +62,113 @@ template <Type typeT> struct BodyIteratorBase
   std::vector<Wrap<typeT>> elems_;
 };
 
+// The edge of _table on the two vertices, or a new EdgeRef.
+Wrap<Type::EDGE> make_edge(const EdgeTable* _table, const IBase* _v0, const IBase* _v1)
+{
+  if (_table != nullptr)
+  {
+    if (auto edge = _table->find(_v0, _v1))
+      return edge;
+  }
+  Wrap<Type::EDGE> edge;
+  auto edref = edge.make<EdgeRef>();
+  edref->verts_[0].reset(static_cast<E<Type::VERTEX>*>(const_cast<IBase*>(_v0)));
+  edref->verts_[1].reset(static_cast<E<Type::VERTEX>*>(const_cast<IBase*>(_v1)));
+  edref->finalise();
+  return edge;
+}
+
+const MeshBody* mesh_of(const Wrap<Type::BODY>& _body)
+{
+  return _body->sub_type() == SubType::MESH_BODY ?
+    static_cast<const MeshBody*>(_body.get()) : nullptr;
+}
+
+// The mesh of the edge, if its vertices are in a MeshBody.
+const MeshBody* mesh_of(const EdgeRef* _edge, size_t _inds[2])
+{
+  for (size_t i = 0; i < 2; ++i)
+  {
+    if (_edge->verts_[i]->sub_type() != SubType::MESH_VERTEX)
+      return nullptr;
+    _inds[i] = static_cast<const MeshVertex*>(_edge->verts_[i].get())->ind_;
+  }
+  return &static_cast<const MeshVertex*>(_edge->verts_[0].get())->mesh();
+}
+
+// Calls _fun(face, ind) for each coedge from _inds[0] to _inds[1] or back,
+// with ind the position in the face of its first vertex, in the order of
+// the EE version. Goes to the next face position if _fun returns true.
+template <class FunT>
+void mesh_coedges(const MeshBody& _mesh, const size_t _inds[2], FunT _fun)
+{
+  const MeshBody::Index* beg[2], * end[2];
+  for (size_t i = 0; i < 2; ++i)
+    _mesh.vertex_faces(_inds[i], beg[i], end[i]);
+  std::vector<MeshBody::Index> common_faces;
+  std::set_intersection(beg[0], end[0], beg[1], end[1],
+    std::back_inserter(common_faces));
+  for (auto f : common_faces)
+  {
+    auto verts = _mesh.face_begin(f);
+    const auto n = _mesh.face_size(f);
+    for (auto pos = n; pos-- > 0;)
+    {
+      if (verts[pos] != _inds[0])
+        continue;
+      const size_t pos_near[2] = { pos > 0 ? pos - 1 : n - 1, pos + 1 < n ? pos + 1 : 0 };
+      for (int i = 0; i < 2; ++i)
+      {
+        if (verts[pos_near[i]] == _inds[1] && _fun(f, i > 0 ? pos : pos_near[0]))
+          break;
+      }
+    }
+  }
+}
+
+// Calls _fun(face, pos, ind) for each coedge of the edge found in the
+// half-edge index, with pos the position of verts_[0] in the face and ind
+// the position of the first vertex of the coedge. The order is the one of
+// the search in the faces of the vertices. False if there is no index.
+template <class FunT>
+bool index_coedges(const EdgeRef* _edge, FunT _fun)
+{
+  auto index = half_edge_index(_edge->verts_[0].get());
+  if (index == nullptr)
+    return false;
+  struct Coedge
+  {
+    Wrap<Type::FACE> face_;
+    size_t pos_, ind_;
+    int side_;
+  };
+  std::vector<Coedge> coedges;
+  std::vector<size_t> hes;
+  for (int i = 0; i < 2; ++i)
+  {
+    // 0: from verts_[1] to verts_[0], 1: from verts_[0] to verts_[1].
+    index->find(_edge->verts_[1 - i].get(), _edge->verts_[i].get(), hes);
+    for (auto he : hes)
+    {
+      const auto& half_edge = (*index)[he];
+      auto face = static_cast<E<Type::FACE>*>(const_cast<IBase*>(half_edge.face_));
+      const auto pos = i == 0 ? (*index)[half_edge.next_].pos_ : half_edge.pos_;
+      coedges.push_back({ face, pos, half_edge.pos_, i });
+    }
+  }
+  std::sort(coedges.begin(), coedges.end(), [](const Coedge& _a, const Coedge& _b)
+  {
+    if (_a.face_ != _b.face_)
+      return _a.face_ < _b.face_;
+    if (_a.pos_ != _b.pos_)
+      return _a.pos_ > _b.pos_;
+    return _a.side_ < _b.side_;
+  });
+  for (const auto& coedge : coedges)
+    _fun(coedge.face_, coedge.pos_, coedge.ind_);
+  return true;
+}
+
 }//namespace
 
 template <>
@@ -67,6 +177,13 @@ struct Iterator<Type::BODY, Type::FACE>::Impl : public BodyIteratorBase<Type::FA
   void reset(const Wrap<Type::BODY>& _from)
   {
     clear();
+    if (auto mesh = mesh_of(_from))
+    {
+      elems_.reserve(mesh->face_number());
+      for (size_t i = 0; i < mesh->face_number(); ++i)
+        elems_.push_back(mesh->face(i));
+      return;
+    }
     if (_from->sub_type() != SubType::BODY)
       throw;
     auto body = static_cast<const EE<Type::BODY>*>(_from.get());
@@ -89,34 +206,31 @@ struct Iterator<Type::BODY, Type::EDGE>::Impl : public BodyIteratorBase<Type::ED
   void reset(const Wrap<Type::BODY>& _from)
   {
     clear();
+    if (auto mesh = mesh_of(_from))
+      return reset(*mesh);
     if (_from->sub_type() != SubType::BODY)
       throw;
 
-    typedef std::array<Object*, 2> Key;
-    struct less_key
+    // The edges are the couples of vertex ids, in the order of the faces.
+    typedef std::pair<Identifier, Identifier> Key;
+    struct KeyHash
     {
-      bool operator()(const Key& _a, const Key& _b) const
-      {
-        if (less_ptr(_a[0], _b[0]))
-          return true;
-        if (less_ptr(_b[0], _a[0]))
-          return false;
-        return less_ptr(_a[1], _b[1]);
-      }
-      bool less_ptr(const Object* _ob0, const Object* _ob1) const
+      size_t operator()(const Key& _key) const
       {
-        if (_ob0 == _ob1 || _ob1 == nullptr)
-          return false;
-        if (_ob0 == nullptr)
-          return true;
-        return *_ob0 < *_ob1;
+        return Utils::hash_combine(size_t(_key.first), size_t(_key.second));
       }
     };
 
     auto body = static_cast<const EE<Type::BODY>*>(_from.get());
+    if (auto table = body->edge_table_.get())
+    {
+      elems_.reserve(table->size());
+      for (size_t i = 0; i < table->size(); ++i)
+        elems_.push_back(table->edge(i));
+      return;
+    }
     auto face_nmbr = body->size(Direction::Down);
-    typedef std::map<Key, Wrap<Type::EDGE>, less_key> EdgeMap;
-    EdgeMap edges;
+    Utils::FlatHashSet<Key, KeyHash> keys;
     for (size_t i = 0; i < face_nmbr; ++i)
     {
       auto child = body->get(Direction::Down, i);
@@ -124,32 +238,47 @@ struct Iterator<Type::BODY, Type::EDGE>::Impl : public BodyIteratorBase<Type::ED
         continue;
       auto face = static_cast<EE<Type::FACE>*>(child);
       auto edge_nmbr = face->size(Direction::Down);
-      Key verts;
-      verts[0] = face->get(Direction::Down, edge_nmbr - 1);
+      IBase* verts[2] = { face->get(Direction::Down, edge_nmbr - 1), nullptr };
       for (size_t j = 0; j < edge_nmbr; ++j)
       {
-        Wrap<Type::EDGE> edg_wrp;
-        auto edg = edg_wrp.make<EdgeRef>();
         verts[1] = face->get(Direction::Down, j);
-
-        for (size_t k = 0; k < 2; ++k)
-        {
-          THROW_IF(verts[k]->type() != Type::VERTEX, "Unexpected type");
-          edg->verts_[k] = static_cast<E<Type::VERTEX>*>(verts[k]);
-        }
-        edg->finalise();
-
-        Key key(verts);
-        if (key[0] > key[1])
-          std::swap(key[0], key[1]);
-        auto it = edges.lower_bound(key);
-        if (it == edges.end() || it->first != key)
-          edges.insert(it, EdgeMap::value_type(key, edg_wrp));
+        for (auto vert : verts)
+          THROW_IF(vert->type() != Type::VERTEX, "Unexpected type");
+        Key key(verts[0]->id(), verts[1]->id());
+        if (key.second < key.first)
+          std::swap(key.first, key.second);
+        if (keys.insert(key).second)
+          elems_.push_back(make_edge(nullptr, verts[0], verts[1]));
         verts[0] = verts[1];
       }
     }
-    for (auto ed : edges)
-      elems_.push_back(ed.second);
+  }
+
+  // The edges are the sorted pairs of point indices, without a map.
+  void reset(const MeshBody& _mesh)
+  {
+    std::vector<uint64_t> keys;
+    keys.reserve(_mesh.face_verts_.size());
+    for (size_t f = 0; f < _mesh.face_number(); ++f)
+    {
+      auto beg = _mesh.face_begin(f), end = _mesh.face_end(f);
+      for (auto v = beg, prev = end - 1; v != end; prev = v++)
+      {
+        auto mm = std::minmax(*prev, *v);
+        keys.push_back(uint64_t(mm.first) << 32 | mm.second);
+      }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    elems_.reserve(keys.size());
+    for (auto key : keys)
+    {
+      Wrap<Type::EDGE> edg_wrp;
+      auto edg = edg_wrp.make<EdgeRef>();
+      edg->verts_[0] = _mesh.vertex(size_t(key >> 32));
+      edg->verts_[1] = _mesh.vertex(size_t(key & 0xffffffff));
+      elems_.push_back(edg_wrp);
+    }
   }
 };
 
@@ -159,11 +288,23 @@ struct Iterator<Type::BODY, Type::VERTEX>::Impl : public BodyIteratorBase<Type::
   void reset (const Wrap<Type::BODY>& _from)
   {
     clear();
+    if (auto mesh = mesh_of(_from))
+    {
+      std::vector<bool> used(mesh->pts_.size(), false);
+      for (auto v : mesh->face_verts_)
+      {
+        if (used[v])
+          continue;
+        used[v] = true;
+        elems_.push_back(mesh->vertex(v));
+      }
+      return;
+    }
     if (_from->sub_type() != SubType::BODY)
       throw;
     auto body = static_cast<const EE<Type::BODY>*>(_from.get());
     auto face_nmbr = body->size(Direction::Down);
-    std::set<EE<Type::VERTEX>*> vertices;
+    Visit visit;
     for (size_t i = 0; i < face_nmbr; ++i)
     {
       auto child = body->get(Direction::Down, i);
@@ -177,7 +318,7 @@ struct Iterator<Type::BODY, Type::VERTEX>::Impl : public BodyIteratorBase<Type::
         if (elem->type() != Type::VERTEX)
           continue;
         auto vert = static_cast<EE<Type::VERTEX>*>(elem);
-        if (vertices.insert(vert).second)
+        if (visit.mark(vert))
           elems_.push_back(vert);
       }
     }
@@ -226,13 +367,18 @@ struct Iterator<Type::VERTEX, Type::EDGE>::Impl : public BodyIteratorBase<Type::
   void reset(const Wrap<Type::VERTEX>& _from)
   {
     clear();
+    if (_from->sub_type() == SubType::MESH_VERTEX)
+      return reset_mesh(_from);
+    if (auto index = half_edge_index(_from.get()))
+      return reset(*index, _from);
 
-    std::set<Wrap<Type::VERTEX>> already_used;
+    Visit already_used;
     for (size_t i = 0; i < _from->size(Direction::Up); ++i)
     {
       auto face = _from->get(Direction::Up, i);
       if (face->type() == Type::FACE)
       {
+        auto table = edge_table(face);
         for (auto pos = face->find_child(_from.get()); pos != SIZE_MAX; 
           pos = face->find_child(_from.get(), pos))
         {
@@ -246,20 +392,89 @@ struct Iterator<Type::VERTEX, Type::EDGE>::Impl : public BodyIteratorBase<Type::
             auto vert_oth = face->get(Direction::Down, pos_oth);
             if (vert_oth->type() != Type::VERTEX)
               continue;
-            Wrap<Type::VERTEX> vert(static_cast<E<Type::VERTEX>*>(vert_oth));
-            if (!already_used.insert(vert).second)
+            if (!already_used.mark(vert_oth))
               continue;
-            Wrap<Type::EDGE> edge;
-            auto edref = edge.make<EdgeRef>();
-            edref->verts_[0] = _from;
-            edref->verts_[1].reset(static_cast<E<Type::VERTEX>*>(vert.get()));
-            edref->finalise();
-            elems_.emplace_back(edge);
+            elems_.push_back(make_edge(table, _from.get(), vert_oth));
           }
         }
       }
     }
   }
+
+  // Same order as the search in the faces, without it.
+  void reset(const HalfEdgeIndex& _index, const Wrap<Type::VERTEX>& _from)
+  {
+    // One sort groups the half-edges by the first position of their face
+    // in the parents, and orders them by decreasing position in the face.
+    Utils::FlatHashMap<const IBase*, size_t> face_rank;
+    for (size_t i = 0; i < _from->size(Direction::Up); ++i)
+      face_rank.emplace(_from->get(Direction::Up, i), i);
+    std::vector<std::pair<size_t, size_t>> hes; // (rank, half-edge)
+    for (auto he : _index.outgoing(_from.get()))
+    {
+      auto rank = face_rank.find(_index[he].face_);
+      if (rank != face_rank.end())
+        hes.emplace_back(rank->second, he);
+    }
+    std::sort(hes.begin(), hes.end(),
+      [&_index](const std::pair<size_t, size_t>& _a, const std::pair<size_t, size_t>& _b)
+    {
+      if (_a.first != _b.first)
+        return _a.first < _b.first;
+      return _index[_a.second].pos_ > _index[_b.second].pos_;
+    });
+    Visit already_used;
+    const IBase* face = nullptr;
+    const EdgeTable* table = nullptr;
+    for (const auto& rank_he : hes)
+    {
+      const auto he = rank_he.second;
+      if (_index[he].face_ != face)
+      {
+        face = _index[he].face_;
+        table = edge_table(face);
+      }
+      for (auto vert_oth : { _index[_index[he].prev_].vert_, _index.end_vertex(he) })
+      {
+        if (vert_oth->type() != Type::VERTEX || !already_used.mark(vert_oth))
+          continue;
+        elems_.push_back(make_edge(table, _from.get(), vert_oth));
+      }
+    }
+  }
+
+  void reset_mesh(const Wrap<Type::VERTEX>& _from)
+  {
+    auto vert = static_cast<const MeshVertex*>(_from.get());
+    const auto& mesh = vert->mesh();
+    const MeshBody::Index* beg, * end;
+    mesh.vertex_faces(vert->ind_, beg, end);
+    std::vector<size_t> already_used;
+    for (auto f = beg; f != end; ++f)
+    {
+      auto verts = mesh.face_begin(*f);
+      const auto n = mesh.face_size(*f);
+      for (auto pos = n; pos-- > 0;)
+      {
+        if (verts[pos] != vert->ind_)
+          continue;
+        for (auto pos_oth : { pos > 0 ? pos - 1 : n - 1, pos + 1 < n ? pos + 1 : 0 })
+        {
+          const size_t oth = verts[pos_oth];
+          if (std::find(already_used.begin(), already_used.end(), oth) !=
+            already_used.end())
+            continue;
+          already_used.push_back(oth);
+          Wrap<Type::EDGE> edge;
+          auto edref = edge.make<EdgeRef>();
+          edref->verts_[0] = _from;
+          edref->verts_[1] = mesh.vertex(oth);
+          edref->finalise();
+          elems_.emplace_back(edge);
+        }
+      }
+    }
+  }
 };
 
 template <>
@@ -270,6 +485,29 @@ struct Iterator<Type::EDGE, Type::COEDGE>::Impl : public BodyIteratorBase<Type::
     clear();
     THROW_IF(_from->sub_type() != SubType::EDGE_REF, "Not expected edge type");
     auto edge_ref = static_cast<const Topo::EdgeRef*>(_from.get());
+    size_t inds[2];
+    if (auto mesh = mesh_of(edge_ref, inds))
+    {
+      mesh_coedges(*mesh, inds, [this, mesh](size_t _f, size_t _ind)
+      {
+        Wrap<Type::COEDGE> coedge;
+        auto cedge_data = coedge.make<CoEdgeRef>();
+        cedge_data->face_ = mesh->face(_f);
+        cedge_data->ind_ = _ind;
+        elems_.emplace_back(coedge);
+        return false;
+      });
+      return;
+    }
+    if (index_coedges(edge_ref, [this](const Wrap<Type::FACE>& _face, size_t, size_t _ind)
+    {
+      Wrap<Type::COEDGE> coedge;
+      auto cedge_data = coedge.make<CoEdgeRef>();
+      cedge_data->face_ = _face;
+      cedge_data->ind_ = _ind;
+      elems_.emplace_back(coedge);
+    }))
+      return;
 
     std::vector<Wrap<Type::FACE>> faces[2], common_faces;
     for (int i = 0; i < 2; ++i)
@@ -325,6 +563,26 @@ struct Iterator<Type::EDGE, Type::FACE>::Impl : public BodyIteratorBase<Type::FA
     clear();
     THROW_IF(_from->sub_type() != SubType::EDGE_REF, "Not expected edge type");
     auto edge_ref = static_cast<const Topo::EdgeRef*>(_from.get());
+    size_t inds[2];
+    if (auto mesh = mesh_of(edge_ref, inds))
+    {
+      mesh_coedges(*mesh, inds, [this, mesh](size_t _f, size_t)
+      {
+        elems_.push_back(mesh->face(_f));
+        return true;
+      });
+      return;
+    }
+    // A face once for each position of verts_[0].
+    size_t last_pos = SIZE_MAX;
+    if (index_coedges(edge_ref,
+      [this, &last_pos](const Wrap<Type::FACE>& _face, size_t _pos, size_t)
+    {
+      if (elems_.empty() || elems_.back() != _face || last_pos != _pos)
+        elems_.push_back(_face);
+      last_pos = _pos;
+    }))
+      return;
 
     std::vector<Wrap<Type::FACE>> faces[2], common_faces;
     for (int i = 0; i < 2; ++i)
@@ -389,16 +647,13 @@ struct Iterator<Type::FACE, Type::EDGE>::Impl : public BodyIteratorBase<Type::ED
     auto nverts = _from->size(Direction::Down);
     if (nverts < 2)
       return;
+    auto table = edge_table(_from.get());
     auto prev = _from->get(Direction::Down, nverts - 1);
     for (auto i = 0; i < nverts; ++i)
     {
-      Wrap<Type::EDGE> edge;
-      auto edref = edge.make<EdgeRef>();
-      edref->verts_[0].reset(static_cast<E<Type::VERTEX>*>(prev));
-      prev = _from->get(Direction::Down, i);
-      edref->verts_[1].reset(static_cast<E<Type::VERTEX>*>(prev));
-      edref->finalise();
-      elems_.emplace_back(edge);
+      auto vert = _from->get(Direction::Down, i);
+      elems_.push_back(make_edge(table, prev, vert));
+      prev = vert;
     }
   }
 };
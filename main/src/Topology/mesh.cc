@@ -0,0 +1,474 @@
+#include "mesh.hh"
+#include "impl.hh"
+#include "persistence.hh"
+#include <Geo/vector.hh>
+#include <Utils/bindata.hh>
+#include <Utils/error_handling.hh>
+#include <Utils/flat_hash.hh>
+
+#include <algorithm>
+#include <numeric>
+
+namespace Topo {
+
+void MeshBody::vertex_faces(size_t _v, const Index*& _beg, const Index*& _end) const
+{
+  std::call_once(vert_faces_made_, [this]() { make_vertex_faces(); });
+  _beg = vert_faces_.data() + vert_offs_[_v];
+  _end = vert_faces_.data() + vert_offs_[_v + 1];
+}
+
+void MeshBody::make_vertex_faces() const
+{
+  // Counting sort of the faces by vertex. A vertex twice in a face gets
+  // the face once: last_face is the last face added to each vertex.
+  const auto NONE = Index(-1);
+  std::vector<Index> last_face(pts_.size(), NONE);
+  vert_offs_.assign(pts_.size() + 1, 0);
+  for (size_t f = 0; f < face_number(); ++f)
+  {
+    for (auto v = face_begin(f); v != face_end(f); ++v)
+    {
+      if (last_face[*v] == Index(f))
+        continue;
+      last_face[*v] = Index(f);
+      ++vert_offs_[*v + 1];
+    }
+  }
+  for (size_t v = 0; v < pts_.size(); ++v)
+    vert_offs_[v + 1] += vert_offs_[v];
+  vert_faces_.resize(vert_offs_.back());
+  std::fill(last_face.begin(), last_face.end(), NONE);
+  std::vector<Index> pos(vert_offs_.begin(), vert_offs_.end() - 1);
+  for (size_t f = 0; f < face_number(); ++f)
+  {
+    for (auto v = face_begin(f); v != face_end(f); ++v)
+    {
+      if (last_face[*v] == Index(f))
+        continue;
+      last_face[*v] = Index(f);
+      vert_faces_[pos[*v]++] = Index(f);
+    }
+  }
+}
+
+Wrap<Type::VERTEX> MeshBody::vertex(size_t _v) const
+{
+  Wrap<Type::VERTEX> vert;
+  auto mesh_vert = vert.make<MeshVertex>();
+  mesh_vert->body_.reset(const_cast<MeshBody*>(this));
+  mesh_vert->ind_ = _v;
+  return vert;
+}
+
+Wrap<Type::FACE> MeshBody::face(size_t _f) const
+{
+  Wrap<Type::FACE> face;
+  auto mesh_face = face.make<MeshFace>();
+  mesh_face->body_.reset(const_cast<MeshBody*>(this));
+  mesh_face->ind_ = _f;
+  return face;
+}
+
+size_t MeshVertex::size(Direction _dir) const
+{
+  if (_dir == Direction::Down)
+    return 0;
+  const MeshBody::Index* beg, * end;
+  mesh().vertex_faces(ind_, beg, end);
+  return end - beg;
+}
+
+IBase* MeshVertex::get(Direction _dir, size_t _i) const
+{
+  if (_dir == Direction::Down)
+    return nullptr;
+  std::call_once(faces_made_, [this]()
+  {
+    const MeshBody::Index* beg, * end;
+    mesh().vertex_faces(ind_, beg, end);
+    for (auto f = beg; f != end; ++f)
+      faces_.push_back(mesh().face(*f));
+  });
+  return faces_.empty() ? nullptr : faces_[_i % faces_.size()].get();
+}
+
+bool MeshVertex::operator<(const Object& _oth) const
+{
+  if (_oth.sub_type() != SubType::MESH_VERTEX)
+    return E<Type::VERTEX>::operator<(_oth);
+  const auto& oth = static_cast<const MeshVertex&>(_oth);
+  return body_ < oth.body_ || (body_ == oth.body_ && ind_ < oth.ind_);
+}
+
+bool MeshVertex::operator==(const Object& _oth) const
+{
+  if (_oth.sub_type() != SubType::MESH_VERTEX)
+    return false;
+  const auto& oth = static_cast<const MeshVertex&>(_oth);
+  return body_ == oth.body_ && ind_ == oth.ind_;
+}
+
+size_t MeshVertex::hash() const
+{
+  return Utils::hash_combine(std::hash<Wrap<Type::BODY>>()(body_), ind_);
+}
+
+size_t MeshFace::size(Direction _dir) const
+{
+  return _dir == Direction::Up ? 1 : mesh().face_size(ind_);
+}
+
+IBase* MeshFace::get(Direction _dir, size_t _i) const
+{
+  if (_dir == Direction::Up)
+    return const_cast<E<Type::BODY>*>(body_.get());
+  std::call_once(verts_made_, [this]()
+  {
+    for (auto v = mesh().face_begin(ind_); v != mesh().face_end(ind_); ++v)
+      verts_.push_back(mesh().vertex(*v));
+  });
+  return verts_.empty() ? nullptr : verts_[_i % verts_.size()].get();
+}
+
+size_t MeshFace::find_parent(const IBase* _prnt) const
+{
+  return _prnt == body_.get() ? 0 : SIZE_MAX;
+}
+
+// As UpEntity::find_child, comparing the indices of the vertices.
+size_t MeshFace::find_child(const IBase* _el, size_t _end) const
+{
+  if (_el == nullptr || _el->sub_type() != SubType::MESH_VERTEX)
+    return SIZE_MAX;
+  auto vert = static_cast<const MeshVertex*>(_el);
+  if (vert->body_ != body_)
+    return SIZE_MAX;
+  auto beg = mesh().face_begin(ind_);
+  for (auto pos = std::min(_end, mesh().face_size(ind_)); pos-- > 0;)
+  {
+    if (beg[pos] == vert->ind_)
+      return pos;
+  }
+  return SIZE_MAX;
+}
+
+bool MeshFace::operator<(const Object& _oth) const
+{
+  if (_oth.sub_type() != SubType::MESH_FACE)
+    return E<Type::FACE>::operator<(_oth);
+  const auto& oth = static_cast<const MeshFace&>(_oth);
+  return body_ < oth.body_ || (body_ == oth.body_ && ind_ < oth.ind_);
+}
+
+bool MeshFace::operator==(const Object& _oth) const
+{
+  if (_oth.sub_type() != SubType::MESH_FACE)
+    return false;
+  const auto& oth = static_cast<const MeshFace&>(_oth);
+  return body_ == oth.body_ && ind_ == oth.ind_;
+}
+
+size_t MeshFace::hash() const
+{
+  return Utils::hash_combine(std::hash<Wrap<Type::BODY>>()(body_), ind_);
+}
+
+Wrap<Type::BODY> make_mesh_body(std::vector<Geo::Point> _pts,
+  std::vector<double> _tols, std::vector<uint32_t> _face_offs,
+  std::vector<uint32_t> _face_verts)
+{
+  THROW_IF(_pts.size() >= size_t(MeshBody::Index(-1)) ||
+    _face_verts.size() >= size_t(MeshBody::Index(-1)), "Mesh too big");
+  THROW_IF(_tols.size() != _pts.size(), "A tolerance for each point expected");
+  THROW_IF(_face_offs.empty() || _face_offs.front() != 0 ||
+    _face_offs.back() != _face_verts.size() ||
+    !std::is_sorted(_face_offs.begin(), _face_offs.end()), "Bad face offsets");
+  for (auto v : _face_verts)
+    THROW_IF(v >= _pts.size(), "Bad point index");
+
+  Wrap<Type::BODY> body;
+  auto mesh = body.make<MeshBody>();
+  mesh->pts_ = std::move(_pts);
+  mesh->tols_ = std::move(_tols);
+  mesh->face_offs_ = std::move(_face_offs);
+  mesh->face_verts_ = std::move(_face_verts);
+  return body;
+}
+
+namespace {
+
+// The vertex and the face objects of the arrays of make_mesh_body, each
+// kind in consecutive blocks of the arena. The faces are kept by _faces.
+void make_faces(const std::vector<Geo::Point>& _pts,
+  const std::vector<double>& _tols, const std::vector<uint32_t>& _face_offs,
+  const std::vector<uint32_t>& _face_verts, std::vector<IBase*>& _faces)
+{
+  auto& arena = Arena::current();
+  arena.reserve(sizeof(EE<Type::VERTEX>), _pts.size());
+  std::vector<Wrap<Type::VERTEX>> verts(_pts.size());
+  for (size_t i = 0; i < verts.size(); ++i)
+  {
+    verts[i].make<EE<Type::VERTEX>>();
+    verts[i]->set_geom(_pts[i]);
+    verts[i]->set_tolerance(_tols[i]);
+  }
+  const auto face_nmbr = _face_offs.empty() ? 0 : _face_offs.size() - 1;
+  arena.reserve(sizeof(EE<Type::FACE>), face_nmbr);
+  _faces.clear();
+  _faces.reserve(face_nmbr);
+  std::vector<IBase*> face_verts;
+  for (size_t f = 0; f < face_nmbr; ++f)
+  {
+    face_verts.clear();
+    for (auto v = _face_offs[f]; v < _face_offs[f + 1]; ++v)
+      face_verts.push_back(verts[_face_verts[v]].get());
+    Wrap<Type::FACE> face;
+    face.make<EE<Type::FACE>>()->set_children(face_verts);
+    face->add_ref();
+    _faces.push_back(face.get());
+  }
+}
+
+void release(std::vector<IBase*>& _faces)
+{
+  for (auto face : _faces)
+    face->release_ref();
+  _faces.clear();
+}
+
+// Puts 2 zero bits after each of the low 21 bits of _x.
+uint64_t spread_bits(uint64_t _x)
+{
+  _x &= 0x1FFFFF;
+  _x = (_x | _x << 32) & 0x1F00000000FFFFull;
+  _x = (_x | _x << 16) & 0x1F0000FF0000FFull;
+  _x = (_x | _x << 8) & 0x100F00F00F00F00Full;
+  _x = (_x | _x << 4) & 0x10C30C30C30C30C3ull;
+  _x = (_x | _x << 2) & 0x1249249249249249ull;
+  return _x;
+}
+
+// Position on the Morton curve of a grid of 2^21 cells a side on the
+// bounding box of the points: the coordinates interleaved bit by bit.
+struct MortonCode
+{
+  MortonCode(const std::vector<Geo::Point>& _pts)
+  {
+    if (_pts.empty())
+      return;
+    auto max = min_ = _pts.front();
+    for (const auto& pt : _pts)
+    {
+      for (size_t i = 0; i < 3; ++i)
+      {
+        min_[i] = std::min(min_[i], pt[i]);
+        max[i] = std::max(max[i], pt[i]);
+      }
+    }
+    double size = 0;
+    for (size_t i = 0; i < 3; ++i)
+      size = std::max(size, max[i] - min_[i]);
+    if (size > 0)
+      scale_ = double(0x1FFFFF) / size;
+  }
+
+  uint64_t operator()(const Geo::Point& _pt) const
+  {
+    uint64_t code = 0;
+    for (size_t i = 0; i < 3; ++i)
+    {
+      auto cell = uint64_t(std::min(std::max((_pt[i] - min_[i]) * scale_, 0.), double(0x1FFFFF)));
+      code |= spread_bits(cell) << i;
+    }
+    return code;
+  }
+
+private:
+  Geo::Point min_ = {};
+  double scale_ = 0;
+};
+
+// The positions that sort the codes.
+std::vector<uint32_t> sorted_order(const std::vector<uint64_t>& _codes)
+{
+  std::vector<uint32_t> order(_codes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+    [&_codes](uint32_t _a, uint32_t _b) { return _codes[_a] < _codes[_b]; });
+  return order;
+}
+
+}//namespace
+
+Wrap<Type::BODY> expand_mesh_body(const Wrap<Type::BODY>& _mesh)
+{
+  THROW_IF(_mesh->sub_type() != SubType::MESH_BODY, "Not a mesh body");
+  auto mesh = static_cast<const MeshBody*>(_mesh.get());
+  std::vector<IBase*> faces;
+  make_faces(mesh->pts_, mesh->tols_, mesh->face_offs_, mesh->face_verts_, faces);
+  Wrap<Type::BODY> body;
+  body.make<EE<Type::BODY>>()->set_children(faces);
+  release(faces);
+  return body;
+}
+
+void spatial_order(std::vector<Geo::Point>& _pts, std::vector<double>& _tols,
+  std::vector<uint32_t>& _face_offs, std::vector<uint32_t>& _face_verts)
+{
+  THROW_IF(_tols.size() != _pts.size() || _face_offs.empty(), "Bad mesh arrays");
+  MortonCode morton(_pts);
+  std::vector<uint64_t> codes(_pts.size());
+  for (size_t i = 0; i < _pts.size(); ++i)
+    codes[i] = morton(_pts[i]);
+  auto pt_order = sorted_order(codes);
+  std::vector<uint32_t> new_inds(_pts.size());
+  std::vector<Geo::Point> pts(_pts.size());
+  std::vector<double> tols(_pts.size());
+  for (size_t i = 0; i < pt_order.size(); ++i)
+  {
+    new_inds[pt_order[i]] = uint32_t(i);
+    pts[i] = _pts[pt_order[i]];
+    tols[i] = _tols[pt_order[i]];
+  }
+  _pts.swap(pts);
+  _tols.swap(tols);
+
+  const auto face_nmbr = _face_offs.size() - 1;
+  codes.resize(face_nmbr);
+  for (size_t f = 0; f < face_nmbr; ++f)
+  {
+    Geo::Point centr = {};
+    const auto beg = _face_offs[f], end = _face_offs[f + 1];
+    for (auto v = beg; v < end; ++v)
+      centr += _pts[new_inds[_face_verts[v]]];
+    if (end > beg)
+      centr /= double(end - beg);
+    codes[f] = morton(centr);
+  }
+  auto face_order = sorted_order(codes);
+  std::vector<uint32_t> face_offs(1, 0), face_verts;
+  face_offs.reserve(_face_offs.size());
+  face_verts.reserve(_face_verts.size());
+  for (auto f : face_order)
+  {
+    for (auto v = _face_offs[f]; v < _face_offs[f + 1]; ++v)
+      face_verts.push_back(new_inds[_face_verts[v]]);
+    face_offs.push_back(uint32_t(face_verts.size()));
+  }
+  _face_offs.swap(face_offs);
+  _face_verts.swap(face_verts);
+}
+
+bool compact(Wrap<Type::BODY>& _body)
+{
+  std::vector<Geo::Point> pts;
+  std::vector<double> tols;
+  std::vector<uint32_t> face_offs(1, 0), face_verts;
+  if (_body->sub_type() == SubType::MESH_BODY)
+  {
+    // The vertex faces of the body are made once: a new body is needed.
+    auto mesh = static_cast<const MeshBody*>(_body.get());
+    pts = mesh->pts_;
+    tols = mesh->tols_;
+    face_offs = mesh->face_offs_;
+    face_verts = mesh->face_verts_;
+    spatial_order(pts, tols, face_offs, face_verts);
+    _body = make_mesh_body(std::move(pts), std::move(tols),
+      std::move(face_offs), std::move(face_verts));
+    return true;
+  }
+  if (_body->sub_type() != SubType::BODY)
+    return false;
+
+  Utils::FlatHashMap<const IBase*, uint32_t> vert_inds;
+  for (size_t f = 0; f < _body->size(Direction::Down); ++f)
+  {
+    auto face = _body->get(Direction::Down, f);
+    if (face->type() != Type::FACE)
+      return false;
+    for (size_t i = 0; i < face->size(Direction::Down); ++i)
+    {
+      auto vert = static_cast<const E<Type::VERTEX>*>(face->get(Direction::Down, i));
+      auto ins = vert_inds.emplace(vert, uint32_t(pts.size()));
+      if (ins.second)
+      {
+        pts.emplace_back();
+        vert->geom(pts.back());
+        tols.push_back(vert->tolerance());
+      }
+      face_verts.push_back(ins.first->second);
+    }
+    face_offs.push_back(uint32_t(face_verts.size()));
+  }
+  spatial_order(pts, tols, face_offs, face_verts);
+  std::vector<IBase*> faces;
+  make_faces(pts, tols, face_offs, face_verts, faces);
+  _body->set_children(faces);
+  release(faces);
+  return true;
+}
+
+namespace {
+
+template <typename T>
+void save_array(std::ostream& _ostr, const std::vector<T>& _arr)
+{
+  _ostr << Utils::BinData<size_t>(_arr.size());
+  _ostr.write(reinterpret_cast<const char*>(_arr.data()), _arr.size() * sizeof(T));
+}
+
+template <typename T>
+void load_array(std::istream& _istr, std::vector<T>& _arr)
+{
+  size_t size;
+  _istr >> Utils::BinData<size_t>(size);
+  _arr.resize(size);
+  _istr.read(reinterpret_cast<char*>(_arr.data()), size * sizeof(T));
+}
+
+}//namespace
+
+template <> void object_saver<SubType::MESH_VERTEX>(std::ostream&, const Object*, ISaver*)
+{
+}
+
+template <> WrapObject
+object_loader<SubType::MESH_VERTEX>(std::istream&, ILoader*)
+{
+  return nullptr;
+}
+
+template <> void object_saver<SubType::MESH_FACE>(std::ostream&, const Object*, ISaver*)
+{
+}
+
+template <> WrapObject
+object_loader<SubType::MESH_FACE>(std::istream&, ILoader*)
+{
+  return nullptr;
+}
+
+template <> void object_saver<SubType::MESH_BODY>(
+  std::ostream& _ostr, const Object* _obj, ISaver*)
+{
+  auto mesh = static_cast<const MeshBody*>(_obj);
+  save_array(_ostr, mesh->pts_);
+  save_array(_ostr, mesh->tols_);
+  save_array(_ostr, mesh->face_offs_);
+  save_array(_ostr, mesh->face_verts_);
+}
+
+template <> WrapObject
+object_loader<SubType::MESH_BODY>(std::istream& _istr, ILoader*)
+{
+  Wrap<Type::BODY> body;
+  auto mesh = body.make<MeshBody>();
+  load_array(_istr, mesh->pts_);
+  load_array(_istr, mesh->tols_);
+  load_array(_istr, mesh->face_offs_);
+  load_array(_istr, mesh->face_verts_);
+  return body.get();
+}
+
+}//namespace Topo
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "topology.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace Topo {
+
+// Makes a body that keeps a mesh in flat arrays (SubType::MESH_BODY): the
+// points and their tolerances, the point indices of all the faces one after
+// the other, and the offset of each face in them (face f is
+// [_face_offs[f], _face_offs[f + 1]), so there is one offset more than the
+// faces). It is read through the Iterators, as any other body, in a small
+// part of the memory of the EE objects.
+Wrap<Type::BODY> make_mesh_body(std::vector<Geo::Point> _pts,
+  std::vector<double> _tols, std::vector<uint32_t> _face_offs,
+  std::vector<uint32_t> _face_verts);
+
+// The same faces in a body made of vertex and face objects, that can be
+// edited, e.g. by a boolean operation.
+Wrap<Type::BODY> expand_mesh_body(const Wrap<Type::BODY>& _mesh);
+
+// Sorts the points of the arrays of make_mesh_body along a Morton curve in
+// their bounding box, and the faces along the curve of their centroids:
+// the points close in space get close in memory, and the faces follow.
+// Equal positions keep their order.
+void spatial_order(std::vector<Geo::Point>& _pts, std::vector<double>& _tols,
+  std::vector<uint32_t>& _face_offs, std::vector<uint32_t>& _face_verts);
+
+// The vertices and the faces of the body in spatial_order. A mesh body gets
+// its arrays sorted. In a body of objects the vertices and the faces are
+// made again in that order, in consecutive blocks of the Arena, so their
+// ids follow it too. The old objects are no longer in the body.
+bool compact(Wrap<Type::BODY>& _body);
+
+}//namespace Topo
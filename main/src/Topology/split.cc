@@ -1,5 +1,7 @@
+#include "half_edge.hh"
 #include "impl.hh"
 #include "split.hh"
+#include "transaction.hh"
 #include "Utils/error_handling.hh"
 
 #include <algorithm>
@@ -12,27 +14,52 @@ void Split<Type::EDGE>::add_point(const Info& inf_) const
 }
 
 bool Split<Type::EDGE>::operator()() const
+{
+  Transaction trans;
+  if (!(*this)(trans))
+    return false;
+  trans.commit();
+  return true;
+}
+
+bool Split<Type::EDGE>::operator()(Transaction& _trans) const
 {
   std::sort(split_pts_.begin(), split_pts_.end(), 
     [](const Info&_a, const Info&_b) { return _a.t_ < _b.t_; });
   if (edge_->sub_type() != SubType::EDGE_REF)
     return false;
   auto ed_ref = static_cast<const EdgeRef*>(edge_.get());
-  std::vector<IBase*> faces[2];
   const EE<Type::VERTEX>* vert_impl[2];
   for (size_t i = 0; i < std::size(ed_ref->verts_); ++i)
-  {
     vert_impl[i] = static_cast<const EE<Type::VERTEX>*>(ed_ref->verts_[i].get());
-    size_t face_nmbr = vert_impl[i]->size(Direction::Up);
-    for (size_t j = 0; j < face_nmbr; ++j)
-      faces[i].push_back(vert_impl[i]->get(Direction::Up, j));
-    std::sort(faces[i].begin(), faces[i].end());
-  }
   std::vector<IBase*> comm_faces;
-  std::set_intersection(
-    faces[0].begin(), faces[0].end(),
-    faces[1].begin(), faces[1].end(),
-    std::back_inserter(comm_faces));
+  if (auto index = half_edge_index(vert_impl[0]))
+  {
+    std::vector<size_t> hes;
+    for (size_t i = 0; i < 2; ++i)
+    {
+      index->find(vert_impl[i], vert_impl[1 - i], hes);
+      for (auto he : hes)
+        comm_faces.push_back(const_cast<IBase*>((*index)[he].face_));
+    }
+    std::sort(comm_faces.begin(), comm_faces.end());
+    comm_faces.erase(std::unique(comm_faces.begin(), comm_faces.end()), comm_faces.end());
+  }
+  else
+  {
+    std::vector<IBase*> faces[2];
+    for (size_t i = 0; i < std::size(ed_ref->verts_); ++i)
+    {
+      size_t face_nmbr = vert_impl[i]->size(Direction::Up);
+      for (size_t j = 0; j < face_nmbr; ++j)
+        faces[i].push_back(vert_impl[i]->get(Direction::Up, j));
+      std::sort(faces[i].begin(), faces[i].end());
+    }
+    std::set_intersection(
+      faces[0].begin(), faces[0].end(),
+      faces[1].begin(), faces[1].end(),
+      std::back_inserter(comm_faces));
+  }
   for (auto face : comm_faces)
   {
     size_t pos = SIZE_MAX;
@@ -44,15 +71,15 @@ bool Split<Type::EDGE>::operator()() const
       auto pos1 = (pos + 1) % face->size(Direction::Down);
       if (face->get(Direction::Down, pos1) == vert_impl[1])
       {
-        for (auto it = split_pts_.rbegin(); it != split_pts_.rend(); ++it)
-          face->insert_child(it->vert_.get(), pos1);
+        for (auto it = split_pts_.begin(); it != split_pts_.end(); ++it)
+          _trans.insert_child(face, it->vert_.get(), pos1);
         continue;
       }
       pos1 = pos == 0 ? face->size(Direction::Down) - 1 : pos - 1;
       if (face->get(Direction::Down, pos1) == vert_impl[1])
       {
-        for (auto it = split_pts_.begin(); it != split_pts_.end(); ++it)
-          face->insert_child(it->vert_.get(), pos);
+        for (auto it = split_pts_.rbegin(); it != split_pts_.rend(); ++it)
+          _trans.insert_child(face, it->vert_.get(), pos);
         continue;
       }
       THROW("Impossible splt edge");
@@ -67,6 +94,7 @@ bool Split<Type::FACE>::operator()(VertexChains& _chains)
 {
   if (_chains.empty())
     return false;
+  Transaction trans;
   for (auto& chain : _chains)
   {
     Wrap<Type::FACE> new_face;
@@ -77,11 +105,12 @@ bool Split<Type::FACE>::operator()(VertexChains& _chains)
     for (size_t i = 0; i < face_->size(Direction::Up); ++i)
     {
       auto parent = face_->get(Direction::Up, i);
-      parent->insert_child(new_face.get());
+      trans.insert_child(parent, new_face.get());
     }
     new_faces_.emplace_back(new_face);
   }
-  face_->remove();
+  trans.remove(face_.get());
+  trans.commit();
   return true;
 }
 
@@ -7,6 +7,8 @@
 
 namespace Topo {
 
+class Transaction;
+
 template <Type TypeT> struct Split;
 
 template <> struct Split<Type::EDGE>
@@ -27,6 +29,11 @@ template <> struct Split<Type::EDGE>
   bool operator != (const Split<Type::EDGE>& _oth) const { return edge_ != _oth.edge_; }
 
   bool operator()() const;
+  // Records the insertions in _trans: many splits are applied together by
+  // its commit. The faces are found before the commit.
+  bool operator()(Transaction& _trans) const;
+
+  const Wrap<Type::EDGE>& edge() const { return edge_; }
 
 private:
   Wrap<Type::EDGE> edge_;
@@ -50,3 +57,15 @@ private:
 };
 
 }//namespace Topology
+
+namespace std {
+
+template <> struct hash<Topo::Split<Topo::Type::EDGE>>
+{
+  size_t operator()(const Topo::Split<Topo::Type::EDGE>& _split) const
+  {
+    return hash<Topo::Wrap<Topo::Type::EDGE>>()(_split.edge());
+  }
+};
+
+}//namespace std
@@ -5,7 +5,8 @@
 
 namespace Topo {
 
-MAKE_ENUM(SubType, VERTEX, EDGE, EDGE_REF, COEDGE, COEDGE_REF, FACE, BODY)
+MAKE_ENUM(SubType, VERTEX, EDGE, EDGE_REF, COEDGE, COEDGE_REF, FACE, BODY,
+  MESH_VERTEX, MESH_FACE, MESH_BODY)
 
 
 }//namespace Topo
\ No newline at end of file
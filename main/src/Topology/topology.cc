@@ -3,16 +3,17 @@
 namespace Topo
 {
 
-Object::Object() : ref_(0)
+Object::Object()
 {
-  static size_t progr_id;
-  id_ = progr_id++;
+  static Counter progr_id;
+  id_ = progr_id.next();
 }
 
 Object::~Object() {}
 
 bool Object::operator<(const Object& _oth) const { return id_ < _oth.id_; }
 bool Object::operator==(const Object& _oth) const { return id_ == _oth.id_; }
+size_t Object::hash() const { return size_t(id_); }
 
 
 
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "arena.hh"
 #include "subtype.hh"
 #include "Geo/entity.hh"
 
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace Topo {
@@ -14,14 +18,46 @@ MAKE_ENUM(Direction, Up, Down );
 
 typedef unsigned __int64 Identifier;
 
+// Counter of the references and of the object ids. The atomic one lets
+// Wrap be copied and objects be made on many threads.
+template <bool atomicT> struct CounterT;
+
+template <> struct CounterT<false>
+{
+  void increase() { ++val_; }
+  size_t decrease() { return --val_; }
+  size_t next() { return val_++; }
+private:
+  size_t val_ = 0;
+};
+
+template <> struct CounterT<true>
+{
+  void increase() { val_.fetch_add(1, std::memory_order_relaxed); }
+  // The object is deleted by the thread that drops the last reference,
+  // after all the others are done with it.
+  size_t decrease() { return val_.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+  size_t next() { return val_.fetch_add(1, std::memory_order_relaxed); }
+private:
+  std::atomic<size_t> val_{ 0 };
+};
+
+// Set by the CMake option TOPO_THREAD_SAFE.
+#ifdef TOPO_THREAD_SAFE
+typedef CounterT<true> Counter;
+#else
+typedef CounterT<false> Counter;
+#endif
+
 struct Object
 {
   template <Type typeT> friend class Wrap;
+  friend class Visit;
 
-  void add_ref() { ++ref_; }
+  void add_ref() { ref_.increase(); }
   void release_ref() 
   {
-    auto refs = --ref_;
+    auto refs = ref_.decrease();
     if (refs == 0)
       delete this;
   }
@@ -30,20 +66,26 @@ struct Object
 
   virtual bool operator<(const Object& _oth) const;
   virtual bool operator==(const Object& _oth) const;
+  // Equal objects have the same hash: the id, or the one of the values
+  // compared by operator==.
+  virtual size_t hash() const;
 
   Identifier id() const { return id_; }
 
 protected:
   Object();
   virtual ~Object();
+  // The blocks go back to the Arena they come from.
+  static void operator delete(void* _ptr) { Arena::deallocate(_ptr); }
 
 private:
-  static void* operator new(std::size_t sz) { return ::operator new(sz); }
+  static void* operator new(std::size_t sz) { return Arena::current().allocate(sz); }
   static void* operator new[](std::size_t sz) { return ::operator new(sz); }
 
 private:
-  size_t ref_;
+  Counter ref_;
   Identifier id_;
+  mutable uint64_t visit_ = 0; // Epoch of the last Visit, see visit.hh.
 };
 
 class WrapObject
@@ -57,6 +99,10 @@ public:
   {
     reset(_oth.ptr_);
   }
+  WrapObject(WrapObject&& _oth) noexcept : ptr_(_oth.ptr_)
+  {
+    _oth.ptr_ = nullptr;
+  }
   ~WrapObject()
   {
     if (ptr_)
@@ -69,6 +115,19 @@ public:
     return *this;
   }
 
+  WrapObject& operator=(WrapObject&& _oth) noexcept
+  {
+    if (this != &_oth)
+    {
+      auto old_ptr = ptr_;
+      ptr_ = _oth.ptr_;
+      _oth.ptr_ = nullptr;
+      if (old_ptr != nullptr)
+        old_ptr->release_ref();
+    }
+    return *this;
+  }
+
   Object* operator->() { return get(); }
 
   const Object* operator->() const { return get(); }
@@ -129,6 +188,8 @@ struct IBase : public Object
   virtual bool remove_child(size_t) { return false; }
   virtual bool remove_child(IBase*) { return false; }
   virtual bool replace_child(IBase* /*_elem*/, IBase* /*_new_elem*/) { return false; }
+  // Sets all the children at once, see Transaction. False if nothing changed.
+  virtual bool set_children(const std::vector<IBase*>&) { return false; }
 protected:
   virtual bool remove_parent(IBase* /*_prnt*/) { return false; }
   virtual bool add_parent(IBase* /*_prnt*/) { return false; }
@@ -194,6 +255,12 @@ public:
       ptr_->add_ref();
   }
 
+  // The reference moves: no counter is touched.
+  Wrap(Wrap<typeT>&& _ew) noexcept : ptr_(_ew.ptr_)
+  {
+    _ew.ptr_ = nullptr;
+  }
+
   ~Wrap()
   {
     if (ptr_)
@@ -206,6 +273,19 @@ public:
     return *this;
   }
 
+  Wrap& operator=(Wrap<typeT>&& _oth) noexcept
+  {
+    if (this != &_oth)
+    {
+      auto old_ptr = ptr_;
+      ptr_ = _oth.ptr_;
+      _oth.ptr_ = nullptr;
+      if (old_ptr != nullptr)
+        old_ptr->release_ref();
+    }
+    return *this;
+  }
+
   E<typeT>* operator->() { return get(); }
 
   const E<typeT>* operator->() const { return get(); }
@@ -250,7 +330,75 @@ private:
   E<typeT>* ptr_;
 };
 
+// Borrowed element: as a Wrap, without counting the references. It is valid
+// while a Wrap keeps the element alive, e.g. in loops on an Iterator.
+template <Type typeT> class Ref
+{
+public:
+  Ref() : ptr_(nullptr) { }
+  Ref(E<typeT>* _ptr) : ptr_(_ptr) { }
+  Ref(const Wrap<typeT>& _wrap) : ptr_(const_cast<E<typeT>*>(_wrap.get())) { }
+
+  E<typeT>* operator->() const { return ptr_; }
+  E<typeT>* get() const { return ptr_; }
+  explicit operator bool() const { return ptr_ != nullptr; }
+
+  // Counted reference, to keep the element.
+  Wrap<typeT> wrap() const { return Wrap<typeT>(ptr_); }
+
+  bool operator<(const Ref<typeT>& _oth) const
+  {
+    if (ptr_ == _oth.ptr_)
+      return false;
+    if (ptr_ != nullptr && _oth.ptr_ != nullptr)
+      return *ptr_ < *_oth.ptr_;
+    return ptr_ == nullptr;
+  }
+
+  bool operator==(const Ref<typeT>& _oth) const
+  {
+    if (ptr_ == _oth.ptr_)
+      return true;
+    if (ptr_ != nullptr && _oth.ptr_ != nullptr)
+      return *ptr_ == *_oth.ptr_;
+    return false;
+  }
+
+  bool operator!=(const Ref<typeT>& _oth) const { return !(*this == _oth); }
+
+private:
+  E<typeT>* ptr_;
+};
+
 typedef std::vector<Topo::Wrap<Topo::Type::VERTEX>> VertexChain;
 typedef std::vector<VertexChain> VertexChains;
 
 }//namespace Topo
+
+namespace std {
+
+template <Topo::Type typeT> struct hash<Topo::Wrap<typeT>>
+{
+  size_t operator()(const Topo::Wrap<typeT>& _wrap) const
+  {
+    return _wrap ? _wrap->hash() : 0;
+  }
+};
+
+template <Topo::Type typeT> struct hash<Topo::Ref<typeT>>
+{
+  size_t operator()(const Topo::Ref<typeT>& _ref) const
+  {
+    return _ref ? _ref->hash() : 0;
+  }
+};
+
+template <> struct hash<Topo::WrapObject>
+{
+  size_t operator()(const Topo::WrapObject& _wrap) const
+  {
+    return _wrap ? _wrap->hash() : 0;
+  }
+};
+
+}//namespace std
@@ -0,0 +1,132 @@
+#include "transaction.hh"
+#include "Utils/error_handling.hh"
+
+#include <algorithm>
+
+namespace Topo {
+
+void Transaction::insert_child(IBase* _prnt, IBase* _el, size_t _pos)
+{
+  THROW_IF(_prnt == nullptr || _el == nullptr, "Null element in transaction");
+  keep(_prnt);
+  keep(_el);
+  edits_[_prnt].inserts_.emplace_back(_pos, _el);
+}
+
+void Transaction::remove_child(IBase* _prnt, IBase* _el)
+{
+  THROW_IF(_prnt == nullptr || _el == nullptr, "Null element in transaction");
+  keep(_prnt);
+  keep(_el);
+  edits_[_prnt].removes_.push_back(_el);
+}
+
+void Transaction::replace(IBase* _el, IBase* _new_el)
+{
+  THROW_IF(_el == nullptr || _new_el == nullptr, "Null element in transaction");
+  if (_el == _new_el)
+    return;
+  keep(_el);
+  keep(_new_el);
+  replaces_[_el] = _new_el;
+}
+
+void Transaction::remove(IBase* _el)
+{
+  THROW_IF(_el == nullptr, "Null element in transaction");
+  keep(_el);
+  removes_.push_back(_el);
+}
+
+bool Transaction::empty() const
+{
+  return edits_.empty() && replaces_.empty() && removes_.empty();
+}
+
+IBase* Transaction::final_element(IBase* _el) const
+{
+  // At most one step per replacement, also if they make a loop.
+  for (size_t i = 0; i < replaces_.size(); ++i)
+  {
+    auto it = replaces_.find(_el);
+    if (it == replaces_.end())
+      break;
+    _el = it->second;
+  }
+  return _el;
+}
+
+bool Transaction::commit()
+{
+  if (empty())
+    return false;
+
+  // The parents of the replaced and of the removed elements are edited too.
+  auto add_parents = [this](const IBase* _el)
+  {
+    for (size_t i = 0; i < _el->size(Direction::Up); ++i)
+      edits_[_el->get(Direction::Up, i)];
+  };
+  for (const auto& repl : replaces_)
+    add_parents(repl.first);
+  Utils::FlatHashSet<const IBase*> removed;
+  for (auto el : removes_)
+  {
+    if (removed.insert(el).second)
+      add_parents(el);
+  }
+
+  std::vector<IBase*> children;
+  Utils::FlatHashMap<const IBase*, size_t> to_remove;
+  for (auto& prnt_edits : edits_)
+  {
+    auto prnt = prnt_edits.first;
+    auto& edits = prnt_edits.second;
+    std::stable_sort(edits.inserts_.begin(), edits.inserts_.end(),
+      [](const std::pair<size_t, IBase*>& _a, const std::pair<size_t, IBase*>& _b)
+    {
+      return _a.first < _b.first;
+    });
+    to_remove.clear();
+    for (auto el : edits.removes_)
+      ++to_remove[el];
+
+    children.clear();
+    auto ins = edits.inserts_.cbegin();
+    const auto child_nmbr = prnt->size(Direction::Down);
+    for (size_t i = 0; i < child_nmbr; ++i)
+    {
+      for (; ins != edits.inserts_.cend() && ins->first <= i; ++ins)
+        children.push_back(final_element(ins->second));
+      auto child = prnt->get(Direction::Down, i);
+      if (removed.count(child) > 0)
+        continue;
+      auto rem = to_remove.find(child);
+      if (rem != to_remove.end() && rem->second > 0)
+      {
+        --rem->second;
+        continue;
+      }
+      children.push_back(final_element(child));
+    }
+    for (; ins != edits.inserts_.cend(); ++ins)
+      children.push_back(final_element(ins->second));
+    prnt->set_children(children);
+  }
+
+  children.clear();
+  for (auto el : removes_)
+    el->set_children(children);
+  clear();
+  return true;
+}
+
+void Transaction::clear()
+{
+  edits_.clear();
+  replaces_.clear();
+  removes_.clear();
+  kept_.clear();
+}
+
+}//namespace Topo
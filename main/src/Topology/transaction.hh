@@ -0,0 +1,54 @@
+#pragma once
+
+#include "topology.hh"
+#include "Utils/flat_hash.hh"
+
+#include <vector>
+
+namespace Topo {
+
+// Edits of the topology applied together. Nothing changes until commit,
+// and the positions refer to the children before the transaction. The
+// commit makes the new children of every parent touched in one pass, so
+// a face split on many edges, or a body that loses many faces, is edited
+// once: the parents of the children, the half-edge index and the edge
+// table are updated once per parent instead of once per edit.
+class Transaction
+{
+public:
+  // Inserts _el in _prnt before the child at _pos, at the end if _pos is
+  // past the last child. The elements inserted at the same position keep
+  // the order of the calls.
+  void insert_child(IBase* _prnt, IBase* _el, size_t _pos = SIZE_MAX);
+  // Removes one _el from the children of _prnt.
+  void remove_child(IBase* _prnt, IBase* _el);
+  // Replaces _el with _new_el in all its parents and in the inserted
+  // elements. The chains of replacements are followed to the end.
+  void replace(IBase* _el, IBase* _new_el);
+  // Removes _el from all its parents and its children from it.
+  void remove(IBase* _el);
+
+  bool empty() const;
+  // Applies the edits, false if there were none. The transaction can be
+  // used again.
+  bool commit();
+  // Drops the edits.
+  void clear();
+
+private:
+  struct Edits
+  {
+    std::vector<std::pair<size_t, IBase*>> inserts_;
+    std::vector<IBase*> removes_;
+  };
+
+  IBase* final_element(IBase* _el) const;
+  void keep(IBase* _el) { kept_.emplace_back(_el); }
+
+  Utils::FlatHashMap<IBase*, Edits> edits_; // By parent.
+  Utils::FlatHashMap<IBase*, IBase*> replaces_;
+  std::vector<IBase*> removes_;
+  std::vector<WrapObject> kept_; // The recorded elements live until commit.
+};
+
+}//namespace Topo
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "impl.hh"
+#include "Utils/error_handling.hh"
+
+namespace Topo {
+
+// Lazy ranges of the elements next to an element. Unlike Iterator, nothing
+// is allocated and no reference is counted: the elements are read from
+// _from while the range is traversed, so the range and the pointers it
+// gives are valid while _from is alive and not edited. Use an Iterator for
+// a snapshot, or for the edges and coedges, that are made on request.
+template <Type FromT, Type ToT> struct View;
+
+// The children (or the parents) of type ToT of an element.
+template <Type FromT, Type ToT, Direction dirT> struct NearView
+{
+  struct iterator
+  {
+    iterator(const IBase* _from, size_t _i, size_t _size)
+      : from_(_from), i_(_i), size_(_size) { skip(); }
+    E<ToT>* operator*() const
+    {
+      return static_cast<E<ToT>*>(from_->get(dirT, i_));
+    }
+    iterator& operator++() { ++i_; skip(); return *this; }
+    bool operator==(const iterator& _oth) const { return i_ == _oth.i_; }
+    bool operator!=(const iterator& _oth) const { return i_ != _oth.i_; }
+  private:
+    void skip()
+    {
+      while (i_ < size_ && from_->get(dirT, i_)->type() != ToT)
+        ++i_;
+    }
+    const IBase* from_;
+    size_t i_, size_;
+  };
+
+  NearView(Ref<FromT> _from) : from_(_from.get()),
+    size_(_from ? _from->size(dirT) : 0)
+  {
+    if (size_ == SIZE_MAX) // Not an element with children.
+      size_ = 0;
+  }
+
+  iterator begin() const { return iterator(from_, 0, size_); }
+  iterator end() const { return iterator(from_, size_, size_); }
+  bool empty() const { return !(begin() != end()); }
+
+private:
+  const IBase* from_;
+  size_t size_;
+};
+
+template <> struct View<Type::BODY, Type::FACE> :
+  public NearView<Type::BODY, Type::FACE, Direction::Down>
+{
+  // A MeshBody has no face objects: use Iterator.
+  View(Ref<Type::BODY> _from) : NearView(_from)
+  {
+    THROW_IF(_from->sub_type() == SubType::MESH_BODY, "No face objects in a mesh body");
+  }
+};
+
+template <> struct View<Type::FACE, Type::VERTEX> :
+  public NearView<Type::FACE, Type::VERTEX, Direction::Down>
+{
+  using NearView::NearView;
+};
+
+template <> struct View<Type::VERTEX, Type::FACE> :
+  public NearView<Type::VERTEX, Type::FACE, Direction::Up>
+{
+  using NearView::NearView;
+};
+
+template <> struct View<Type::EDGE, Type::VERTEX>
+{
+  View(Ref<Type::EDGE> _from)
+  {
+    if (_from->sub_type() == SubType::EDGE_REF)
+    {
+      auto ed_ref = static_cast<const EdgeRef*>(_from.get());
+      for (size_t i = 0; i < 2; ++i)
+        verts_[i] = const_cast<E<Type::VERTEX>*>(ed_ref->verts_[i].get());
+    }
+    else
+      THROW("UNEXPECTED_EDGE_TYPE");
+  }
+  E<Type::VERTEX>* const* begin() const { return verts_; }
+  E<Type::VERTEX>* const* end() const { return verts_ + 2; }
+  size_t size() const { return 2; }
+  E<Type::VERTEX>* operator[](size_t _i) const { return verts_[_i]; }
+private:
+  E<Type::VERTEX>* verts_[2];
+};
+
+template <> struct View<Type::COEDGE, Type::FACE>
+{
+  View(Ref<Type::COEDGE> _from)
+  {
+    THROW_IF(_from->sub_type() != SubType::COEDGE_REF, "Not expected coedge type");
+    face_ = const_cast<E<Type::FACE>*>(
+      static_cast<const CoEdgeRef*>(_from.get())->face_.get());
+  }
+  E<Type::FACE>* const* begin() const { return &face_; }
+  E<Type::FACE>* const* end() const { return &face_ + 1; }
+  size_t size() const { return 1; }
+  E<Type::FACE>* operator[](size_t) const { return face_; }
+private:
+  E<Type::FACE>* face_;
+};
+
+}//namespace Topo
@@ -0,0 +1,27 @@
+#include "visit.hh"
+
+#include <atomic>
+
+namespace Topo {
+
+namespace {
+
+std::atomic<bool> marks_owned{ false };
+// Changed only by the owner of the marks: the epochs never repeat.
+uint64_t last_epoch = 0;
+
+}//namespace
+
+Visit::Visit()
+{
+  if (!marks_owned.exchange(true, std::memory_order_acquire))
+    epoch_ = ++last_epoch;
+}
+
+Visit::~Visit()
+{
+  if (epoch_ != 0)
+    marks_owned.store(false, std::memory_order_release);
+}
+
+}//namespace Topo
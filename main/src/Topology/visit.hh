@@ -0,0 +1,48 @@
+#pragma once
+
+#include "topology.hh"
+#include "Utils/flat_hash.hh"
+
+namespace Topo {
+
+// Objects visited by a traversal, e.g. to skip the vertices shared by many
+// faces. The first Visit alive owns the marks of the objects: it stamps
+// its epoch on the objects it visits, so a test is one comparison and no
+// memory is allocated. The marks are shared by all the threads: the
+// Visits made while the marks are owned (on another thread, or nested in
+// the owner) fall back to a hash set of the objects.
+class Visit
+{
+public:
+  Visit();
+  ~Visit();
+  Visit(const Visit&) = delete;
+  Visit& operator=(const Visit&) = delete;
+
+  // Marks the object as visited, false if it already was.
+  bool mark(const Object* _obj)
+  {
+    if (epoch_ == 0)
+      return visited_.insert(_obj).second;
+    if (_obj->visit_ == epoch_)
+      return false;
+    _obj->visit_ = epoch_;
+    return true;
+  }
+
+  bool marked(const Object* _obj) const
+  {
+    if (epoch_ == 0)
+      return visited_.count(_obj) > 0;
+    return _obj->visit_ == epoch_;
+  }
+
+  // True if it uses the marks of the objects.
+  bool owns_marks() const { return epoch_ != 0; }
+
+private:
+  uint64_t epoch_ = 0;
+  Utils::FlatHashSet<const Object*> visited_;
+};
+
+}//namespace Topo
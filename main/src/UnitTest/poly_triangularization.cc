@@ -1,7 +1,9 @@
 #include "catch/catch.hpp"
 
 #include <PolygonTriangularization/poly_triang.hh>
+#include <PolygonTriangularization/triang_cache.hh>
 
+#include <algorithm>
 #include <fstream>
 
 static void write_obj(const char* _flnm,
@@ -257,3 +259,612 @@ TEST_CASE(TEST_NAME, "[PolyTriang]")
   REQUIRE(ptg->area() == 4);
 }
 
+#undef TEST_NAME
+#define TEST_NAME "monotone_1"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  auto ptg = IPolygonTriangulation::make(
+    IPolygonTriangulation::Strategy::MONOTONE);
+  std::vector<Geo::Vector3> plgn;
+  plgn.push_back({ 0,   0,   0 });
+  plgn.push_back({ 2,   0,   0 });
+  plgn.push_back({ 2,   1,   0 });
+  plgn.push_back({ 1,   1,   0 });
+  plgn.push_back({ 2,   2,   0 });
+  plgn.push_back({ 3,   2,   0 });
+  plgn.push_back({ 3,   0,   0 });
+  plgn.push_back({ 4,   0,   0 });
+  plgn.push_back({ 4,   4,   0 });
+  plgn.push_back({ 0,   4,   0 });
+
+  ptg->add(plgn);
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, plgn, tris);
+  REQUIRE(ptg->area() == Approx(13.5));
+  REQUIRE(tris.size() == plgn.size() - 2);
+}
+
+#undef TEST_NAME
+#define TEST_NAME "monotone_2"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  auto ptg = IPolygonTriangulation::make(
+    IPolygonTriangulation::Strategy::MONOTONE);
+  std::vector<Geo::Vector3> plgn;
+
+  plgn.push_back({ 0, 0, 0 });
+  plgn.push_back({ 1, 0, 0 });
+  plgn.push_back({ 1, 1, 0 });
+  plgn.push_back({ 0, 2, 0 });
+  plgn.push_back({ -1, 2, 0 });
+  plgn.push_back({ -2, 0, 0 });
+  plgn.push_back({ -2,-2, 0 });
+  plgn.push_back({ 0,-4, 0 });
+  plgn.push_back({ 0,-3, 0 });
+  plgn.push_back({ -1,-2, 0 });
+  plgn.push_back({ -1,-1, 0 });
+  plgn.push_back({ -1.5, 0, 0 });
+  plgn.push_back({ -1, 0, 0 });
+  plgn.push_back({ 0, 1, 0 });
+
+  ptg->add(plgn);
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, plgn, tris);
+  REQUIRE(ptg->area() == Approx(7.25));
+  REQUIRE(tris.size() == plgn.size() - 2);
+}
+
+#undef TEST_NAME
+#define TEST_NAME "monotone_3"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  auto ptg = IPolygonTriangulation::make(
+    IPolygonTriangulation::Strategy::MONOTONE);
+  {
+    std::vector<Geo::Vector3> plgn =
+    {
+      { 1, 0, 0 },
+      { 2, 1, 0 },
+      { 1, 2, 0 },
+      { 2, 3, 0 },
+      { 1, 4, 0 },
+      { 2, 5, 0 },
+      { 1, 6, 0 },
+      {-1, 6, 0 },
+      {-2, 5, 0 },
+      {-1, 4, 0 },
+      {-2, 3, 0 },
+      {-1, 2, 0 },
+      {-2, 1, 0 },
+      {-1, 0, 0 }
+    };
+    ptg->add(plgn);
+  }
+  {
+    std::vector<Geo::Vector3> plgn =
+    {
+      { -0.5,  0.5, 0 },
+      {  0.5,  0.5, 0 },
+      {  0.5,  1.5, 0 },
+      { -0.5,  1.5, 0 }
+    };
+    ptg->add(plgn);
+  }
+  {
+    std::vector<Geo::Vector3> plgn =
+    {
+      { -0.5,  3.5, 0 },
+      {  0.5,  3.5, 0 },
+      {  0.5,  4.5, 0 },
+      { -0.5,  4.5, 0 }
+    };
+    ptg->add(plgn);
+  }
+
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, ptg->polygon(), tris);
+  REQUIRE(tris.size() == 24);
+  REQUIRE(ptg->area() == Approx(16));
+}
+
+#undef TEST_NAME
+#define TEST_NAME "monotone_4"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Comb in a tilted plane: many split and merge vertices.
+  const size_t teeth = 200;
+  std::vector<Geo::Vector3> plgn;
+  for (size_t i = 0; i < teeth; ++i)
+  {
+    plgn.push_back({ 2. * i,      0., 0. });
+    plgn.push_back({ 2. * i + 1., 0., 0. });
+    plgn.push_back({ 2. * i + 1., 9., 0. });
+    plgn.push_back({ 2. * i + 2., 9., 0. });
+  }
+  plgn.push_back({ 2. * teeth, 10., 0. });
+  plgn.push_back({ 0.,         10., 0. });
+  for (auto& pt : plgn)
+    pt = { pt[0], pt[1] * 0.6, pt[1] * 0.8 };
+
+  auto ptg = IPolygonTriangulation::make(
+    IPolygonTriangulation::Strategy::MONOTONE);
+  ptg->add(plgn);
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, plgn, tris);
+  REQUIRE(tris.size() == plgn.size() - 2);
+  REQUIRE(ptg->area() == Approx(teeth * 2. + teeth * 9.));
+}
+#undef TEST_NAME
+#define TEST_NAME "tilted_island"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Polygon with an island in a plane not parallel to the coordinate ones.
+  std::vector<Geo::Vector3> outer = {
+    { 0, 0, 0 }, { 3, 0, 0 }, { 3, 3, 0 }, { 0, 3, 0 } };
+  std::vector<Geo::Vector3> island = {
+    { 1, 1, 0 }, { 2, 1, 0 }, { 2, 2, 0 }, { 1, 2, 0 } };
+  auto ptg = IPolygonTriangulation::make();
+  for (auto* loop : { &outer, &island })
+  {
+    for (auto& pt : *loop)
+      pt = { pt[0] * 0.8, pt[1], pt[0] * 0.6 };
+    ptg->add(*loop);
+  }
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, ptg->polygon(), tris);
+  REQUIRE(tris.size() == 8);
+  REQUIRE(ptg->area() == Approx(8));
+}
+
+#undef TEST_NAME
+#define TEST_NAME "ear_clipping_1"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  auto ptg = IPolygonTriangulation::make(
+    IPolygonTriangulation::Strategy::EAR_CLIPPING);
+  std::vector<Geo::Vector3> plgn;
+  plgn.push_back({ 0, 0, 0 });
+  plgn.push_back({ 1, 0, 0 });
+  plgn.push_back({ 1, 1, 0 });
+  plgn.push_back({ 0, 2, 0 });
+  plgn.push_back({ -1, 2, 0 });
+  plgn.push_back({ -2, 0, 0 });
+  plgn.push_back({ -2,-2, 0 });
+  plgn.push_back({ 0,-4, 0 });
+  plgn.push_back({ 0,-3, 0 });
+  plgn.push_back({ -1,-2, 0 });
+  plgn.push_back({ -1,-1, 0 });
+  plgn.push_back({ -1.5, 0, 0 });
+  plgn.push_back({ -1, 0, 0 });
+  plgn.push_back({ 0, 1, 0 });
+
+  ptg->add(plgn);
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, plgn, tris);
+  REQUIRE(ptg->area() == Approx(7.25));
+  REQUIRE(tris.size() == plgn.size() - 2);
+}
+
+#undef TEST_NAME
+#define TEST_NAME "ear_clipping_2"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  auto ptg = IPolygonTriangulation::make(
+    IPolygonTriangulation::Strategy::EAR_CLIPPING);
+  std::vector<Geo::Vector3> plgn;
+  plgn.push_back({ 0, 0, 0 });
+  plgn.push_back({ 3, 0, 0 });
+  plgn.push_back({ 3, 3, 0 });
+  plgn.push_back({ 0, 3, 0 });
+  ptg->add(plgn);
+
+  plgn.clear();
+  plgn.push_back({ 1, 1, 0 });
+  plgn.push_back({ 2, 1, 0 });
+  plgn.push_back({ 2, 2, 0 });
+  plgn.push_back({ 1, 2, 0 });
+  ptg->add(plgn);
+
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, ptg->polygon(), tris);
+  REQUIRE(ptg->area() == Approx(8));
+  REQUIRE(tris.size() == 8);
+}
+
+#undef TEST_NAME
+#define TEST_NAME "ear_clipping_3"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Comb: every tooth has two reflex vertices.
+  const size_t teeth = 200;
+  std::vector<Geo::Vector3> plgn;
+  for (size_t i = 0; i < teeth; ++i)
+  {
+    plgn.push_back({ 2. * i,      0., 0. });
+    plgn.push_back({ 2. * i + 1., 0., 0. });
+    plgn.push_back({ 2. * i + 1., 9., 0. });
+    plgn.push_back({ 2. * i + 2., 9., 0. });
+  }
+  plgn.push_back({ 2. * teeth, 10., 0. });
+  plgn.push_back({ 0.,         10., 0. });
+
+  auto ptg = IPolygonTriangulation::make(
+    IPolygonTriangulation::Strategy::EAR_CLIPPING);
+  ptg->add(plgn);
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, plgn, tris);
+  REQUIRE(tris.size() == plgn.size() - 2);
+  REQUIRE(ptg->area() == Approx(teeth * 2. + teeth * 9.));
+}
+
+#undef TEST_NAME
+#define TEST_NAME "comb_island"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // The long edges of the teeth cross most rows of the bridge search.
+  const size_t teeth = 200;
+  std::vector<Geo::Vector3> plgn;
+  for (size_t i = 0; i < teeth; ++i)
+  {
+    plgn.push_back({ 2. * i,      0., 0. });
+    plgn.push_back({ 2. * i + 1., 0., 0. });
+    plgn.push_back({ 2. * i + 1., 9., 0. });
+    plgn.push_back({ 2. * i + 2., 9., 0. });
+  }
+  plgn.push_back({ 2. * teeth, 10., 0. });
+  plgn.push_back({ 0.,         10., 0. });
+  const std::vector<Geo::Vector3> island = {
+    { 100.25, 9.25, 0 }, { 100.75, 9.25, 0 }, { 100.75, 9.75, 0 }, { 100.25, 9.75, 0 } };
+
+  for (auto strat : { IPolygonTriangulation::Strategy::MIN_ANGLE,
+    IPolygonTriangulation::Strategy::EAR_CLIPPING })
+  {
+    auto ptg = IPolygonTriangulation::make(strat);
+    ptg->add(plgn);
+    ptg->add(island);
+    auto& tris = ptg->triangles();
+    REQUIRE(tris.size() == plgn.size() + island.size());
+    REQUIRE(ptg->area() == Approx(teeth * 2. + teeth * 9. - 0.25));
+  }
+}
+
+#undef TEST_NAME
+#define TEST_NAME "ear_clipping_4"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Collinear runs folding back on a vertex: only flat corners are left,
+  // and the dropped one must not block the ears of its neighbours.
+  std::vector<Geo::Vector3> plgn = {
+    { -3, -3, 0 }, { -1, -2, 0 }, { 1, -1, 0 }, { -1, 2, 0 }, { -1, 1, 0 },
+    { -1, 0, 0 }, { -2, 0, 0 }, { 0, 0, 0 }, { -3, 0, 0 }, { -3, -1, 0 } };
+  auto ptg = IPolygonTriangulation::make(
+    IPolygonTriangulation::Strategy::EAR_CLIPPING);
+  ptg->add(plgn);
+  auto& tris = ptg->triangles();
+  write_obj(TEST_NAME, plgn, tris);
+  REQUIRE(ptg->area() == Approx(9));
+}
+
+#undef TEST_NAME
+#define TEST_NAME "failure_not_stored"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Not simple: the partial triangulation must not be kept as the result.
+  std::vector<Geo::Vector3> plgn = {
+    { -3, -3, 0 }, { 0, 0, 0 }, { -2, -2, 0 }, { -1, -1, 0 }, { 2, 2, 0 },
+    { 0, 1, 0 }, { -1, 2, 0 } };
+  for (auto strat : { IPolygonTriangulation::Strategy::EAR_CLIPPING,
+    IPolygonTriangulation::Strategy::MONOTONE })
+  {
+    auto ptg = IPolygonTriangulation::make(strat);
+    ptg->add(plgn);
+    REQUIRE_THROWS(ptg->triangles());
+    REQUIRE_THROWS(ptg->triangles());
+    REQUIRE_THROWS(ptg->area());
+  }
+}
+
+#undef TEST_NAME
+#define TEST_NAME "many_islands"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Perforated plate: the islands are bridged from right to left.
+  const size_t hole_nmbr = 10;
+  for (auto strat : { IPolygonTriangulation::Strategy::MIN_ANGLE,
+    IPolygonTriangulation::Strategy::EAR_CLIPPING })
+  {
+    const size_t row_nmbr =
+      strat == IPolygonTriangulation::Strategy::MIN_ANGLE ? 3 : hole_nmbr;
+    const double side = 3. * row_nmbr;
+    auto ptg = IPolygonTriangulation::make(strat);
+    ptg->add({ { 0, 0, 0 }, { side, 0, 0 }, { side, side, 0 }, { 0, side, 0 } });
+    for (size_t i = 0; i < row_nmbr; ++i)
+    {
+      for (size_t j = 0; j < row_nmbr; ++j)
+      {
+        const double x = 3. * i + 1, y = 3. * j + 1;
+        ptg->add({ { x, y, 0 }, { x, y + 1, 0 }, { x + 1, y + 1, 0 }, { x + 1, y, 0 } });
+      }
+    }
+    auto& tris = ptg->triangles();
+    write_obj(TEST_NAME, ptg->polygon(), tris);
+    REQUIRE(tris.size() == 2 + 6 * row_nmbr * row_nmbr);
+    REQUIRE(ptg->area() == Approx(8. * row_nmbr * row_nmbr));
+  }
+}
+
+#undef TEST_NAME
+#define TEST_NAME "triangulate_all"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Enough polygons to use more threads: star shaped with 3 to 10 points.
+  std::vector<std::vector<Geo::Vector3>> polys(1000);
+  for (size_t i = 0; i < polys.size(); ++i)
+  {
+    const size_t pt_nmbr = 3 + i % 8;
+    for (size_t j = 0; j < pt_nmbr; ++j)
+    {
+      const double ang = 2 * M_PI * j / pt_nmbr;
+      const double rad = j % 2 == 0 ? 2 : 1;
+      polys[i].push_back({ 5. * i + rad * cos(ang), rad * sin(ang), 0 });
+    }
+  }
+  std::vector<std::array<size_t, 3>> tris;
+  std::vector<size_t> tri_ends;
+  IPolygonTriangulation::triangulate_all(polys, tris, tri_ends);
+  REQUIRE(tri_ends.size() == polys.size());
+  REQUIRE(tri_ends.back() == tris.size());
+  size_t beg = 0;
+  for (size_t i = 0; i < polys.size(); beg = tri_ends[i++])
+  {
+    auto ptg = IPolygonTriangulation::make();
+    ptg->add(polys[i]);
+    const auto& exp_tris = ptg->triangles();
+    REQUIRE(tri_ends[i] - beg == exp_tris.size());
+    REQUIRE(std::equal(exp_tris.begin(), exp_tris.end(), tris.begin() + beg));
+  }
+}
+
+#undef TEST_NAME
+#define TEST_NAME "simple_polygons"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  struct Case
+  {
+    std::vector<Geo::Vector3> plgn_;
+    double area_;
+  };
+  const Case cases[] = {
+    { { { 0, 0, 0 }, { 2, 0, 0 }, { 0, 1, 1 } }, std::sqrt(2.) },
+    { { { 0, 0, 0 }, { 2, 0, 0 }, { 2, 1, 0 }, { 0, 1, 0 } }, 2 },
+    // Concave quad, the only valid diagonal starts at (1, 1).
+    { { { 0, 0, 0 }, { 2, 0, 0 }, { 1, 1, 0 }, { 1, 3, 0 } }, 2 },
+    { { { 0, 0, 0 }, { 2, 0, 0 }, { 3, 1, 0 }, { 2, 2, 0 }, { 0, 2, 0 }, { -1, 1, 0 } }, 6 }
+  };
+  for (const auto& cs : cases)
+  {
+    for (auto strat : { IPolygonTriangulation::Strategy::MIN_ANGLE,
+      IPolygonTriangulation::Strategy::MONOTONE,
+      IPolygonTriangulation::Strategy::EAR_CLIPPING })
+    {
+      auto ptg = IPolygonTriangulation::make(strat);
+      ptg->add(cs.plgn_);
+      const auto& tris = ptg->triangles();
+      REQUIRE(tris.size() == cs.plgn_.size() - 2);
+      REQUIRE(ptg->area() == Approx(cs.area_));
+    }
+  }
+}
+
+#undef TEST_NAME
+#define TEST_NAME "sink"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  for (auto strat : { IPolygonTriangulation::Strategy::MIN_ANGLE,
+    IPolygonTriangulation::Strategy::MONOTONE,
+    IPolygonTriangulation::Strategy::EAR_CLIPPING })
+  {
+    auto ptg = IPolygonTriangulation::make(strat);
+    ptg->add({ { 0, 0, 0 }, { 6, 0, 0 }, { 6, 3, 0 }, { 0, 3, 0 } });
+    ptg->add({ { 1, 1, 0 }, { 1, 2, 0 }, { 2, 2, 0 }, { 2, 1, 0 } });
+    ptg->add({ { 4, 1, 0 }, { 4, 2, 0 }, { 5, 2, 0 }, { 5, 1, 0 } });
+
+    // Streamed before and after the triangulation is stored.
+    std::vector<std::array<uint32_t, 3>> strm_tris;
+    IPolygonTriangulation::VectorSink<uint32_t> sink(strm_tris);
+    ptg->triangulate(sink);
+    const auto& tris = ptg->triangles();
+    REQUIRE(tris.size() == 14);
+    REQUIRE(ptg->area() == Approx(16));
+    ptg->triangulate(sink);
+    REQUIRE(strm_tris.size() == 2 * tris.size());
+    for (size_t i = 0; i < strm_tris.size(); ++i)
+    {
+      const auto& tri = tris[i % tris.size()];
+      for (size_t j = 0; j < 3; ++j)
+        REQUIRE(strm_tris[i][j] == tri[j]);
+    }
+  }
+
+  std::vector<std::vector<Geo::Vector3>> polys(100);
+  for (size_t i = 0; i < polys.size(); ++i)
+  {
+    const size_t pt_nmbr = 3 + i % 8;
+    for (size_t j = 0; j < pt_nmbr; ++j)
+    {
+      const double ang = 2 * M_PI * j / pt_nmbr;
+      const double rad = j % 2 == 0 ? 2 : 1;
+      polys[i].push_back({ 5. * i + rad * cos(ang), rad * sin(ang), 0 });
+    }
+  }
+  std::vector<std::array<size_t, 3>> tris;
+  std::vector<std::array<uint32_t, 3>> tris32;
+  std::vector<size_t> tri_ends, tri_ends32;
+  IPolygonTriangulation::triangulate_all(polys, tris, tri_ends);
+  IPolygonTriangulation::triangulate_all(polys, tris32, tri_ends32);
+  REQUIRE(tri_ends == tri_ends32);
+  for (size_t i = 0; i < tris.size(); ++i)
+  {
+    for (size_t j = 0; j < 3; ++j)
+      REQUIRE(tris32[i][j] == tris[i][j]);
+  }
+}
+
+#undef TEST_NAME
+#define TEST_NAME "parallel"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Star and plate with holes split in pieces for 4 threads.
+  std::vector<std::vector<Geo::Vector3>> star(1), plate(1);
+  const size_t pt_nmbr = 2000;
+  for (size_t j = 0; j < pt_nmbr; ++j)
+  {
+    const double ang = 2 * M_PI * j / pt_nmbr;
+    const double rad = j % 2 == 0 ? 2 : 1;
+    star[0].push_back({ rad * cos(ang), rad * sin(ang), 0 });
+  }
+  const size_t row_nmbr = 10;
+  const double side = 3. * row_nmbr;
+  plate[0] = { { 0, 0, 0 }, { side, 0, 0 }, { side, side, 0 }, { 0, side, 0 } };
+  for (size_t i = 0; i < row_nmbr; ++i)
+  {
+    for (size_t j = 0; j < row_nmbr; ++j)
+    {
+      const double x = 3. * i + 1, y = 3. * j + 1;
+      plate.push_back({ { x, y, 0 }, { x, y + 1, 0 }, { x + 1, y + 1, 0 }, { x + 1, y, 0 } });
+    }
+  }
+  for (auto strat : { IPolygonTriangulation::Strategy::MIN_ANGLE,
+    IPolygonTriangulation::Strategy::MONOTONE,
+    IPolygonTriangulation::Strategy::EAR_CLIPPING })
+  {
+    for (const auto& loops : { star, plate })
+    {
+      if (strat == IPolygonTriangulation::Strategy::MIN_ANGLE && loops.size() == 1)
+        continue; // Too slow.
+      auto ptg = IPolygonTriangulation::make(strat);
+      auto ref = IPolygonTriangulation::make(IPolygonTriangulation::Strategy::EAR_CLIPPING);
+      size_t loop_pt_nmbr = 0;
+      for (const auto& loop : loops)
+      {
+        ptg->add(loop);
+        ref->add(loop);
+        loop_pt_nmbr += loop.size();
+      }
+      ptg->set_parallel(100, 4);
+      const auto& tris = ptg->triangles();
+      REQUIRE(tris.size() == loop_pt_nmbr + 2 * (loops.size() - 1) - 2);
+      REQUIRE(ptg->area() == Approx(ref->area()));
+      const auto& pts = ptg->polygon();
+      for (const auto& tri : tris)
+      {
+        const auto norm = (pts[tri[1]] - pts[tri[0]]) % (pts[tri[2]] - pts[tri[0]]);
+        REQUIRE(norm[2] > 0);
+      }
+    }
+  }
+}
+
+#undef TEST_NAME
+#define TEST_NAME "float"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  // Comb with an island on integer coordinates, the same in float and
+  // double: the projections and the triangles are the same.
+  std::vector<Geo::Vector3> outer, island;
+  const size_t tooth_nmbr = 20;
+  for (size_t i = 0; i < tooth_nmbr; ++i)
+  {
+    outer.push_back({ 2. * i, 0, 1 });
+    outer.push_back({ 2. * i + 1, 0, 1 });
+    outer.push_back({ 2. * i + 1, 9, 1 });
+    outer.push_back({ 2. * i + 2, 9, 1 });
+  }
+  outer.push_back({ 2. * tooth_nmbr, 12, 1 });
+  outer.push_back({ 0, 12, 1 });
+  std::reverse(outer.begin(), outer.end());
+  island = { { 4, 10, 1 }, { 4, 11, 1 }, { 30, 11, 1 }, { 30, 10, 1 } };
+  auto to_float = [](const std::vector<Geo::Vector3>& _plgn)
+  {
+    std::vector<Geo::Vector3f> plgn_f;
+    for (const auto& pt : _plgn)
+      plgn_f.push_back({ float(pt[0]), float(pt[1]), float(pt[2]) });
+    return plgn_f;
+  };
+  for (auto strat : { IPolygonTriangulation::Strategy::MIN_ANGLE,
+    IPolygonTriangulation::Strategy::MONOTONE,
+    IPolygonTriangulation::Strategy::EAR_CLIPPING })
+  {
+    auto ptg = IPolygonTriangulation::make(strat);
+    auto ptg_f = IPolygonTriangulationT<float>::make(strat);
+    ptg->add(outer);
+    ptg->add(island);
+    ptg_f->add(to_float(outer));
+    ptg_f->add(to_float(island));
+    REQUIRE(ptg_f->triangles() == ptg->triangles());
+    REQUIRE(ptg_f->area() == ptg->area());
+    REQUIRE(ptg_f->polygon().size() == ptg->polygon().size());
+  }
+
+  std::vector<std::array<uint32_t, 3>> tris, tris_f;
+  std::vector<size_t> ends, ends_f;
+  IPolygonTriangulation::triangulate_all({ outer }, tris, ends);
+  IPolygonTriangulationT<float>::triangulate_all({ to_float(outer) }, tris_f, ends_f);
+  REQUIRE(tris_f == tris);
+  REQUIRE(ends_f == ends);
+}
+
+#undef TEST_NAME
+#define TEST_NAME "cache"
+TEST_CASE(TEST_NAME, "[PolyTriang]")
+{
+  std::vector<std::vector<Geo::Vector3>> polys;
+  for (size_t pt_nmbr : { 5, 8, 13 })
+  {
+    polys.emplace_back();
+    for (size_t j = 0; j < pt_nmbr; ++j)
+    {
+      const double ang = 2 * M_PI * j / pt_nmbr;
+      const double rad = j % 2 == 0 ? 4 : 3;
+      polys.back().push_back({ rad * cos(ang), rad * sin(ang), 0 });
+    }
+  }
+  auto cache = ITriangulationCache::make(2);
+  const auto tris = cache->triangles(polys[0]);
+  REQUIRE(tris->size() == polys[0].size() - 2);
+  auto ptg = IPolygonTriangulation::make();
+  ptg->add(polys[0]);
+  REQUIRE(ptg->triangles().size() == tris->size());
+  for (size_t i = 0; i < tris->size(); ++i)
+  {
+    for (size_t j = 0; j < 3; ++j)
+      REQUIRE((*tris)[i][j] == ptg->triangles()[i][j]);
+  }
+  REQUIRE(cache->triangles(polys[0]) == tris);
+  REQUIRE(cache->hits() == 1);
+  REQUIRE(cache->misses() == 1);
+
+  // A copy is found too, a moved point is not.
+  auto plgn = polys[0];
+  REQUIRE(cache->triangles(plgn) == tris);
+  plgn[2][0] += 1e-12;
+  REQUIRE(cache->triangles(plgn) != tris);
+  REQUIRE(cache->hits() == 2);
+  REQUIRE(cache->misses() == 2);
+
+  // The least recently used polygon is dropped.
+  const auto all_tris = cache->triangles_all(polys);
+  REQUIRE(cache->size() == 2);
+  REQUIRE(all_tris[0] == tris);
+  for (size_t i = 0; i < polys.size(); ++i)
+    REQUIRE(all_tris[i]->size() == polys[i].size() - 2);
+  REQUIRE(cache->misses() == 4);
+  cache->triangles(polys[0]);
+  REQUIRE(cache->misses() == 5);
+  cache->triangles(polys[2]);
+  REQUIRE(cache->hits() == 4);
+
+  cache->clear();
+  REQUIRE(cache->size() == 0);
+  REQUIRE(cache->hits() == 0);
+}
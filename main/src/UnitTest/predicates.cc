@@ -0,0 +1,120 @@
+#include "catch/catch.hpp"
+
+#include <Geo/entity.hh>
+#include <Geo/point_in_polygon.hh>
+#include <Geo/predicates.hh>
+#include <PolygonTriangularization/poly_triang.hh>
+
+#include <cmath>
+
+namespace {
+int sign(double _val)
+{
+  return (_val > 0) - (_val < 0);
+}
+}
+
+#undef TEST_NAME
+#define TEST_NAME "orient2d"
+TEST_CASE(TEST_NAME, "[Predicates]")
+{
+  // Points around 0.5 on a grid of ulps, against the line y = x. The double
+  // formula gets many of the signs wrong.
+  const double ulp = std::ldexp(1., -53);
+  const Geo::Vector<2> b = { 12, 12 }, c = { 24, 24 };
+  for (int i = 0; i < 64; ++i)
+  {
+    for (int j = 0; j < 64; ++j)
+    {
+      const Geo::Vector<2> a = { 0.5 + i * ulp, 0.5 + j * ulp };
+      REQUIRE(sign(Geo::orient2d(a, b, c)) == sign(j - i));
+      REQUIRE(sign(Geo::orient2d(b, a, c)) == -sign(j - i));
+    }
+  }
+  REQUIRE(Geo::orient2d({ 0, 0 }, { 1, 0 }, { 0, 1 }) == 1);
+}
+
+#undef TEST_NAME
+#define TEST_NAME "incircle"
+TEST_CASE(TEST_NAME, "[Predicates]")
+{
+  const Geo::Vector<2> a = { 5, 0 }, b = { 3, 4 }, c = { -4, 3 };
+  const double ulp = std::ldexp(1., -50);
+  REQUIRE(Geo::incircle(a, b, c, { 0, -5 }) == 0);
+  REQUIRE(Geo::incircle(a, b, c, { 0, -5 + ulp }) > 0);
+  REQUIRE(Geo::incircle(a, b, c, { 0, -5 - 2 * ulp }) < 0);
+  REQUIRE(Geo::incircle(a, b, c, { 0, 0 }) > 0);
+  REQUIRE(Geo::incircle(a, b, c, { 10, 10 }) < 0);
+  // Clockwise triangle: the sign is reversed.
+  REQUIRE(Geo::incircle(c, b, a, { 0, 0 }) < 0);
+}
+
+#undef TEST_NAME
+#define TEST_NAME "near_collinear_polygon"
+TEST_CASE(TEST_NAME, "[Predicates]")
+{
+  // Rectangle with many points on the long sides, every other one moved by
+  // an ulp outside or inside.
+  const size_t side_nmbr = 50;
+  std::vector<Geo::Vector3> plgn;
+  for (size_t i = 0; i <= side_nmbr; ++i)
+  {
+    const double y = i % 2 == 0 ? 0 : std::ldexp(i % 4 == 1 ? 1. : -1., -60);
+    plgn.push_back({ double(i), y, 0 });
+  }
+  for (size_t i = side_nmbr + 1; i-- > 0;)
+    plgn.push_back({ double(i), 1, 0 });
+  for (auto strat : { IPolygonTriangulation::Strategy::MIN_ANGLE,
+    IPolygonTriangulation::Strategy::MONOTONE,
+    IPolygonTriangulation::Strategy::EAR_CLIPPING })
+  {
+    auto ptg = IPolygonTriangulation::make(strat);
+    ptg->add(plgn);
+    REQUIRE(ptg->triangles().size() == plgn.size() - 2);
+    REQUIRE(ptg->area() == Approx(side_nmbr));
+  }
+}
+
+#undef TEST_NAME
+#define TEST_NAME "float_kernels"
+TEST_CASE(TEST_NAME, "[Predicates]")
+{
+  const std::vector<Geo::Vector3f> sqr_f = {
+    { 0, 0, 1 }, { 4, 0, 1 }, { 4, 4, 1 }, { 0, 4, 1 } };
+  const std::vector<Geo::Vector3> sqr = {
+    { 0, 0, 1 }, { 4, 0, 1 }, { 4, 4, 1 }, { 0, 4, 1 } };
+  using namespace Geo::PointInPolygon;
+  REQUIRE(classify(sqr_f, { 1, 2, 1 }) == Inside);
+  REQUIRE(classify(sqr_f, { 5, 2, 1 }) == Outside);
+  REQUIRE(classify(sqr_f, { 4, 2, 1 }) == On);
+  REQUIRE(classify(sqr_f, { 2, 2, 1 }, 0.1f) == classify(sqr, { 2, 2, 1 }, 0.1));
+
+  const Geo::SegmentT<float> seg_f = { { { 0, 0, 0 }, { 4, 0, 0 } } };
+  const Geo::Vector3f pt_a_f = { 1, 2, 0 };
+  float t_f, dist_f;
+  REQUIRE(Geo::closest_point(seg_f, pt_a_f, nullptr, &t_f, &dist_f));
+  REQUIRE(t_f == Approx(0.25));
+  REQUIRE(dist_f == Approx(4));
+
+  const Geo::SegmentT<float> seg_b_f = { { { 1, -1, 1 }, { 1, 1, -1 } } };
+  Geo::Vector3f pt_f;
+  float pars_f[2];
+  REQUIRE(Geo::closest_point(seg_f, seg_b_f, &pt_f, pars_f));
+  REQUIRE(pt_f[0] == Approx(1));
+  REQUIRE(pars_f[1] == Approx(0.5));
+
+  const Geo::TriangleT<float> tri_f = { { { 0, 0, 0 }, { 4, 0, 0 }, { 0, 4, 0 } } };
+  const Geo::Triangle tri = { { { 0, 0, 0 }, { 4, 0, 0 }, { 0, 4, 0 } } };
+  const Geo::Vector3f pt_b_f = { 1, 1, 3 };
+  const Geo::Point pt_b = { 1, 1, 3 };
+  double dist;
+  Geo::Point pt;
+  REQUIRE(Geo::closest_point(tri_f, pt_b_f, &pt_f, &dist_f));
+  REQUIRE(Geo::closest_point(tri, pt_b, &pt, &dist));
+  REQUIRE(dist_f == Approx(dist));
+  for (size_t i = 0; i < 3; ++i)
+    REQUIRE(pt_f[i] == Approx(pt[i]));
+  REQUIRE(Geo::closest_point(tri_f, seg_b_f, &pt_f, &t_f, &dist_f));
+  REQUIRE(t_f == Approx(0.5));
+  REQUIRE(dist_f == Approx(0));
+}
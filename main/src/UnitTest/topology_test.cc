@@ -2,10 +2,25 @@
 
 #include "topology_help.hh"
 
+#include <Topology/edge_table.hh>
+#include <Topology/half_edge.hh>
 #include <Topology/iterator.hh>
+#include <Topology/mesh.hh>
+#include <Topology/split.hh>
+#include <Topology/transaction.hh>
+#include <Topology/view.hh>
+#include <Topology/visit.hh>
 #include <Boolean/boolean.hh>
 #include <Geo/vector.hh>
 #include <Import/import.hh>
+#include <Utils/flat_hash.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <thread>
 
 using namespace UnitTest;
 
@@ -42,6 +57,778 @@ TEST_CASE("make body", "[Topo]")
   REQUIRE(bv.size() == 8);
 }
 
+#ifdef TOPO_THREAD_SAFE
+TEST_CASE("thread safe", "[Topo]")
+{
+  // Many threads iterate on the same body, copying the wraps of its
+  // elements, and make new vertices.
+  Topo::Wrap<Topo::Type::BODY> body = make_cube(cube_00);
+  const size_t thrd_nmbr = 4, turn_nmbr = 200;
+  std::vector<std::vector<Topo::Identifier>> ids(thrd_nmbr);
+  std::vector<size_t> sizes(thrd_nmbr, 0);
+  std::vector<std::thread> thrds;
+  for (size_t i = 0; i < thrd_nmbr; ++i)
+  {
+    thrds.emplace_back([&body, &ids, &sizes, i]()
+    {
+      for (size_t j = 0; j < turn_nmbr; ++j)
+      {
+        Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be;
+        be.reset(body);
+        Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv;
+        bv.reset(body);
+        std::vector<Topo::Wrap<Topo::Type::VERTEX>> copies(bv.begin(), bv.end());
+        sizes[i] += be.size() + copies.size();
+        Topo::Wrap<Topo::Type::VERTEX> vert;
+        vert.make<Topo::EE<Topo::Type::VERTEX>>();
+        ids[i].push_back(vert->id());
+      }
+    });
+  }
+  for (auto& thrd : thrds)
+    thrd.join();
+  std::set<Topo::Identifier> all_ids;
+  for (size_t i = 0; i < thrd_nmbr; ++i)
+  {
+    REQUIRE(sizes[i] == turn_nmbr * 20);
+    all_ids.insert(ids[i].begin(), ids[i].end());
+  }
+  REQUIRE(all_ids.size() == thrd_nmbr * turn_nmbr);
+
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be;
+  be.reset(body);
+  REQUIRE(be.size() == 12);
+}
+#endif
+
+TEST_CASE("arena", "[Topo]")
+{
+  // All the objects of the body and of the iterators come from the arena
+  // and go back to it.
+  Topo::Arena arena;
+  {
+    Topo::Wrap<Topo::Type::BODY> body;
+    {
+      Topo::ArenaScope scope(arena);
+      body = make_cube(cube_00);
+    }
+    const auto body_live = arena.live();
+    REQUIRE(body_live == 1 + 6 + 8);
+    {
+      Topo::ArenaScope scope(arena);
+      Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be;
+      be.reset(body);
+      REQUIRE(be.size() == 12);
+      REQUIRE(arena.live() > body_live);
+    }
+    REQUIRE(arena.live() == body_live);
+    // Made outside the scope: the global arena.
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be;
+    be.reset(body);
+    REQUIRE(arena.live() == body_live);
+  }
+  REQUIRE(arena.live() == 0);
+}
+
+TEST_CASE("arena alignment", "[Topo]")
+{
+  // The blocks are aligned as the ones of the global operator new, in the
+  // pools and beyond them.
+  Topo::Arena arena;
+  std::vector<void*> blocks;
+  for (size_t size = 1; size <= 1024; size += 7)
+    blocks.push_back(arena.allocate(size));
+  for (auto block : blocks)
+  {
+    REQUIRE(reinterpret_cast<std::uintptr_t>(block) %
+      alignof(std::max_align_t) == 0);
+    Topo::Arena::deallocate(block);
+  }
+  REQUIRE(arena.live() == 0);
+}
+
+TEST_CASE("arena outlived", "[Topo]")
+{
+  // The blocks in use when the arena is destroyed stay valid.
+  Topo::Wrap<Topo::Type::BODY> body;
+  {
+    Topo::Arena arena;
+    Topo::ArenaScope scope(arena);
+    body = make_cube(cube_00);
+  }
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv;
+  bv.reset(body);
+  REQUIRE(bv.size() == 8);
+  body = Topo::Wrap<Topo::Type::BODY>();
+}
+
+TEST_CASE("wrap move", "[Topo]")
+{
+  // Moves do not count the references and Ref does not keep the element.
+  Topo::Arena arena;
+  Topo::ArenaScope scope(arena);
+  Topo::Wrap<Topo::Type::VERTEX> vert;
+  vert.make<Topo::EE<Topo::Type::VERTEX>>();
+  Topo::Ref<Topo::Type::VERTEX> ref(vert);
+  auto moved = std::move(vert);
+  REQUIRE(!vert);
+  REQUIRE(moved.get() == ref.get());
+  REQUIRE(ref == Topo::Ref<Topo::Type::VERTEX>(moved));
+  REQUIRE(ref.wrap() == moved);
+
+  Topo::WrapObject obj(moved.get());
+  Topo::WrapObject moved_obj(std::move(obj));
+  REQUIRE(!obj);
+  moved = Topo::Wrap<Topo::Type::VERTEX>();
+  REQUIRE(arena.live() == 1);
+  moved_obj = Topo::WrapObject();
+  REQUIRE(arena.live() == 0);
+}
+
+TEST_CASE("flat hash", "[Topo]")
+{
+  // Same content as a std::map after many insertions and erasures.
+  Utils::FlatHashMap<size_t, size_t> map;
+  std::map<size_t, size_t> ref_map;
+  for (size_t i = 0; i < 5000; ++i)
+  {
+    const auto key = (i * 7919) % 1021;
+    if (i % 3 == 2)
+      REQUIRE(map.erase(key) == ref_map.erase(key));
+    else
+      map[key] = ref_map[key] = i;
+  }
+  REQUIRE(map.size() == ref_map.size());
+  for (const auto& val : ref_map)
+  {
+    auto it = map.find(val.first);
+    REQUIRE(it != map.end());
+    REQUIRE(it->second == val.second);
+  }
+
+  // Edges with the same vertices have the same hash.
+  auto body = make_cube(cube_00);
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(body);
+  REQUIRE(be.size() == 12);
+  Utils::FlatHashSet<Topo::Wrap<Topo::Type::EDGE>> edges;
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(body);
+  for (auto& face : bf)
+  {
+    Topo::Iterator<Topo::Type::FACE, Topo::Type::EDGE> fe(face);
+    edges.insert(fe.begin(), fe.end());
+  }
+  REQUIRE(edges.size() == be.size());
+  for (auto& edge : be)
+    REQUIRE(edges.count(edge) == 1);
+}
+
+TEST_CASE("elem list", "[Topo]")
+{
+  // A fan of 100 triangles: the lists of the apex and of the body are
+  // indexed.
+  const size_t n = 100;
+  Topo::Wrap<Topo::Type::BODY> body;
+  auto bd = body.make<Topo::EE<Topo::Type::BODY>>();
+  Topo::Wrap<Topo::Type::VERTEX> apex;
+  apex.make<Topo::EE<Topo::Type::VERTEX>>();
+  std::vector<Topo::Wrap<Topo::Type::VERTEX>> rim(n);
+  for (auto& vert : rim)
+    vert.make<Topo::EE<Topo::Type::VERTEX>>();
+  std::vector<Topo::Wrap<Topo::Type::FACE>> faces(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto face = faces[i].make<Topo::EE<Topo::Type::FACE>>();
+    face->insert_child(apex.get());
+    face->insert_child(rim[i].get());
+    face->insert_child(rim[(i + 1) % n].get());
+    bd->insert_child(face);
+  }
+  REQUIRE(apex->size(Topo::Direction::Up) == n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    REQUIRE(apex->find_parent(faces[i].get()) == i);
+    REQUIRE(body->find_child(faces[i].get()) == i);
+  }
+  for (size_t i = 0; i < n; i += 2)
+    faces[i]->remove();
+  REQUIRE(apex->size(Topo::Direction::Up) == n / 2);
+  REQUIRE(body->size(Topo::Direction::Down) == n / 2);
+  REQUIRE(apex->find_parent(faces[0].get()) == SIZE_MAX);
+  for (size_t i = 1; i < n; i += 2)
+  {
+    REQUIRE(apex->find_parent(faces[i].get()) == i / 2);
+    REQUIRE(body->find_child(faces[i].get()) == i / 2);
+  }
+
+  // A big face with a repeated vertex.
+  Topo::Wrap<Topo::Type::FACE> face;
+  auto big = face.make<Topo::EE<Topo::Type::FACE>>();
+  for (size_t i = 0; i < 40; ++i)
+    big->insert_child(rim[i].get());
+  big->insert_child(rim[5].get(), 20);
+  REQUIRE(big->find_child(rim[5].get()) == 20);
+  REQUIRE(big->find_child(rim[5].get(), 20) == 5);
+  REQUIRE(big->find_child(rim[30].get()) == 31);
+  big->remove_child(size_t(5));
+  REQUIRE(big->find_child(rim[5].get()) == 19);
+  REQUIRE(big->find_child(rim[5].get(), 19) == SIZE_MAX);
+  REQUIRE(big->find_child(rim[30].get()) == 30);
+  big->reverse();
+  REQUIRE(big->find_child(rim[0].get()) == 39);
+  REQUIRE(big->find_child(rim[5].get()) == 20);
+}
+
+TEST_CASE("visit", "[Topo]")
+{
+  // The outer Visit owns the marks, the nested one uses a hash set.
+  auto body = make_cube(cube_00);
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv(body);
+  REQUIRE(bv.size() == 8);
+  {
+    Topo::Visit outer;
+    REQUIRE(outer.owns_marks());
+    for (auto& vert : bv)
+    {
+      REQUIRE(outer.mark(vert.get()));
+      Topo::Visit inner;
+      REQUIRE(!inner.owns_marks());
+      Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv_in(body);
+      REQUIRE(bv_in.size() == 8);
+      Topo::Iterator<Topo::Type::VERTEX, Topo::Type::EDGE> ve(vert);
+      REQUIRE(ve.size() == 3);
+      REQUIRE(inner.mark(vert.get()));
+      REQUIRE(!inner.mark(vert.get()));
+    }
+    for (auto& vert : bv)
+      REQUIRE(!outer.mark(vert.get()));
+  }
+  // A new Visit does not see the old marks.
+  Topo::Visit visit;
+  REQUIRE(visit.owns_marks());
+  for (auto& vert : bv)
+    REQUIRE(!visit.marked(vert.get()));
+}
+
+TEST_CASE("mesh body", "[Topo]")
+{
+  // The cube of make_cube in flat arrays.
+  std::vector<Geo::Point> pts;
+  for (size_t i = 0; i < 8; ++i)
+    pts.push_back({ cube_00(i, 0), cube_00(i, 1), cube_00(i, 2) });
+  std::vector<double> tols(8, 1e-15);
+  std::vector<uint32_t> face_offs = { 0, 4, 8, 12, 16, 20, 24 };
+  std::vector<uint32_t> face_verts = {
+    4, 5, 7, 6,  0, 2, 3, 1,  0, 1, 5, 4,  2, 6, 7, 3,  1, 3, 7, 5,  0, 4, 6, 2 };
+  auto mesh = Topo::make_mesh_body(pts, tols, face_offs, face_verts);
+  REQUIRE(mesh->sub_type() == Topo::SubType::MESH_BODY);
+
+  auto check = [](const Topo::Wrap<Topo::Type::BODY>& _body)
+  {
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(_body);
+    REQUIRE(bf.size() == 6);
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv(_body);
+    REQUIRE(bv.size() == 8);
+    for (auto& vert : bv)
+    {
+      Topo::Iterator<Topo::Type::VERTEX, Topo::Type::EDGE> ve(vert);
+      REQUIRE(ve.size() == 3);
+    }
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(_body);
+    REQUIRE(be.size() == 12);
+    double length = 0;
+    for (auto& edge : be)
+    {
+      Geo::Segment seg;
+      REQUIRE(edge->geom(seg));
+      length += Geo::length(seg[1] - seg[0]);
+      Topo::Iterator<Topo::Type::EDGE, Topo::Type::FACE> ef(edge);
+      REQUIRE(ef.size() == 2);
+      Topo::Iterator<Topo::Type::EDGE, Topo::Type::COEDGE> ec(edge);
+      REQUIRE(ec.size() == 2);
+      for (auto& coedge : ec)
+      {
+        Geo::Segment co_seg;
+        REQUIRE(coedge->geom(co_seg));
+        REQUIRE(((co_seg[0] == seg[0] && co_seg[1] == seg[1]) ||
+          (co_seg[0] == seg[1] && co_seg[1] == seg[0])));
+      }
+    }
+    REQUIRE(length == 12);
+  };
+  check(mesh);
+  check(Topo::expand_mesh_body(mesh));
+  check(make_cube(cube_00));
+
+  // The vertices are references to the points of the body.
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv(mesh);
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(mesh);
+  Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv(bf.get(0));
+  REQUIRE(fv.get(0) == bv.get(0));
+  Geo::Point pt{ 2, 0, 0 };
+  bv.get(0)->set_geom(pt);
+  Geo::Point pt_oth;
+  fv.get(0)->geom(pt_oth);
+  REQUIRE(pt_oth == pt);
+}
+
+#ifdef TOPO_THREAD_SAFE
+TEST_CASE("mesh body thread safe", "[Topo]")
+{
+  // Many threads ask the faces of the same new mesh vertices and the
+  // vertices of the same new mesh faces, made on the first request.
+  std::vector<Geo::Point> pts;
+  for (size_t i = 0; i < 8; ++i)
+    pts.push_back({ cube_00(i, 0), cube_00(i, 1), cube_00(i, 2) });
+  std::vector<uint32_t> face_offs = { 0, 4, 8, 12, 16, 20, 24 };
+  std::vector<uint32_t> face_verts = {
+    4, 5, 7, 6,  0, 2, 3, 1,  0, 1, 5, 4,  2, 6, 7, 3,  1, 3, 7, 5,  0, 4, 6, 2 };
+  auto mesh = Topo::make_mesh_body(pts, std::vector<double>(8, 1e-15),
+    face_offs, face_verts);
+  const auto& mesh_body = static_cast<const Topo::MeshBody&>(*mesh.get());
+  const size_t thrd_nmbr = 4, turn_nmbr = 50;
+  for (size_t turn = 0; turn < turn_nmbr; ++turn)
+  {
+    std::vector<Topo::Wrap<Topo::Type::VERTEX>> verts;
+    for (size_t v = 0; v < 8; ++v)
+      verts.push_back(mesh_body.vertex(v));
+    std::vector<Topo::Wrap<Topo::Type::FACE>> faces;
+    for (size_t f = 0; f < 6; ++f)
+      faces.push_back(mesh_body.face(f));
+    std::vector<size_t> found(thrd_nmbr, 0);
+    std::vector<std::thread> thrds;
+    for (size_t i = 0; i < thrd_nmbr; ++i)
+    {
+      thrds.emplace_back([&verts, &faces, &found, i]()
+      {
+        for (const auto& vert : verts)
+        {
+          for (size_t j = 0; j < vert->size(Topo::Direction::Up); ++j)
+            found[i] += vert->get(Topo::Direction::Up, j) != nullptr;
+        }
+        for (const auto& face : faces)
+        {
+          for (size_t j = 0; j < face->size(Topo::Direction::Down); ++j)
+            found[i] += face->get(Topo::Direction::Down, j) != nullptr;
+        }
+      });
+    }
+    for (auto& thrd : thrds)
+      thrd.join();
+    for (auto nmbr : found)
+      REQUIRE(nmbr == 8 * 3 + 6 * 4);
+  }
+}
+#endif
+
+TEST_CASE("view", "[Topo]")
+{
+  // The views give the same elements as the iterators.
+  Topo::Wrap<Topo::Type::BODY> body = make_cube(cube_00);
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(body);
+  std::vector<Topo::E<Topo::Type::FACE>*> faces;
+  for (auto face : Topo::View<Topo::Type::BODY, Topo::Type::FACE>(body))
+    faces.push_back(face);
+  REQUIRE(faces.size() == bf.size());
+  for (size_t i = 0; i < bf.size(); ++i)
+  {
+    REQUIRE(faces[i] == bf.get(i).get());
+    Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv(bf.get(i));
+    Topo::View<Topo::Type::FACE, Topo::Type::VERTEX> fv_view(bf.get(i));
+    REQUIRE(std::equal(fv.begin(), fv.end(), fv_view.begin(),
+      [](const Topo::Wrap<Topo::Type::VERTEX>& _a, Topo::E<Topo::Type::VERTEX>* _b)
+    {
+      return _a.get() == _b;
+    }));
+    for (auto vert : fv_view)
+    {
+      size_t n = 0;
+      for (auto face : Topo::View<Topo::Type::VERTEX, Topo::Type::FACE>(vert))
+        n += face == faces[i];
+      REQUIRE(n == 1);
+    }
+  }
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(body);
+  for (auto& edge : be)
+  {
+    Topo::Iterator<Topo::Type::EDGE, Topo::Type::VERTEX> ev(edge);
+    Topo::View<Topo::Type::EDGE, Topo::Type::VERTEX> ev_view(edge);
+    REQUIRE(ev_view.size() == 2);
+    REQUIRE((ev_view[0] == ev.get(0).get() && ev_view[1] == ev.get(1).get()));
+    Topo::Iterator<Topo::Type::EDGE, Topo::Type::COEDGE> ec(edge);
+    for (auto& coedge : ec)
+    {
+      Topo::Iterator<Topo::Type::COEDGE, Topo::Type::FACE> cf(coedge);
+      Topo::View<Topo::Type::COEDGE, Topo::Type::FACE> cf_view(coedge);
+      REQUIRE(cf_view[0] == cf.get(0).get());
+    }
+  }
+  Topo::Wrap<Topo::Type::VERTEX> vert;
+  vert.make<Topo::EE<Topo::Type::VERTEX>>();
+  REQUIRE(Topo::View<Topo::Type::VERTEX, Topo::Type::FACE>(vert).empty());
+}
+
+namespace
+{
+// The results of the iterators from all the vertices and edges of a body.
+struct Adjacency
+{
+  Adjacency(const Topo::Wrap<Topo::Type::BODY>& _body)
+  {
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv(_body);
+    for (auto& vert : bv)
+    {
+      Topo::Iterator<Topo::Type::VERTEX, Topo::Type::EDGE> ve(vert);
+      edges_.insert(edges_.end(), ve.begin(), ve.end());
+    }
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(_body);
+    for (auto& edge : be)
+    {
+      Topo::Iterator<Topo::Type::EDGE, Topo::Type::FACE> ef(edge);
+      faces_.insert(faces_.end(), ef.begin(), ef.end());
+      Topo::Iterator<Topo::Type::EDGE, Topo::Type::COEDGE> ec(edge);
+      coedges_.insert(coedges_.end(), ec.begin(), ec.end());
+    }
+  }
+  bool operator==(const Adjacency& _oth) const
+  {
+    return edges_ == _oth.edges_ && faces_ == _oth.faces_ && coedges_ == _oth.coedges_;
+  }
+  std::vector<Topo::Wrap<Topo::Type::EDGE>> edges_;
+  std::vector<Topo::Wrap<Topo::Type::FACE>> faces_;
+  std::vector<Topo::Wrap<Topo::Type::COEDGE>> coedges_;
+};
+}// namespace
+
+TEST_CASE("half edge index", "[Topo]")
+{
+  // The iterators must give the same results with and without the index,
+  // also after the body is edited.
+  Topo::Wrap<Topo::Type::BODY> body = make_cube(cube_00);
+  auto check = [&body]()
+  {
+    REQUIRE(Topo::has_half_edge_index(body));
+    Adjacency with_index(body);
+    Topo::remove_half_edge_index(body);
+    REQUIRE(Adjacency(body) == with_index);
+    REQUIRE(Topo::add_half_edge_index(body));
+    return with_index;
+  };
+  REQUIRE(Topo::add_half_edge_index(body));
+  auto adj = check();
+  REQUIRE(adj.edges_.size() == 8 * 3);
+  REQUIRE(adj.faces_.size() == 12 * 2);
+  REQUIRE(adj.coedges_.size() == 12 * 2);
+
+  // Split an edge in its middle.
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(body);
+  auto edge = be.get(0);
+  Geo::Segment seg;
+  edge->geom(seg);
+  Topo::Split<Topo::Type::EDGE>::Info info;
+  info.vert_.make<Topo::EE<Topo::Type::VERTEX>>();
+  info.clsst_pt_ = (seg[0] + seg[1]) / 2.;
+  info.vert_->set_geom(info.clsst_pt_);
+  info.t_ = 0.5;
+  info.dist_ = 0;
+  Topo::Split<Topo::Type::EDGE> split(edge);
+  split.add_point(info);
+  REQUIRE(split());
+  adj = check();
+  REQUIRE(adj.edges_.size() == 9 * 3 - 1);
+  REQUIRE(adj.coedges_.size() == 13 * 2);
+
+  // Reverse a face and remove another one.
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(body);
+  REQUIRE(bf.get(1)->reverse());
+  check();
+  REQUIRE(bf.get(0)->remove());
+  adj = check();
+  REQUIRE(adj.faces_.size() < 12 * 2);
+}
+
+TEST_CASE("edge table", "[Topo]")
+{
+  // The edges are the same objects in all the queries, and the same
+  // couples of vertices as without the table.
+  Topo::Wrap<Topo::Type::BODY> body = make_cube(cube_00);
+  auto vertex_pairs = [&body]()
+  {
+    std::set<std::pair<size_t, size_t>> pairs;
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(body);
+    for (auto& edge : be)
+    {
+      Topo::Iterator<Topo::Type::EDGE, Topo::Type::VERTEX> ev(edge);
+      auto v0 = ev.get(0)->id(), v1 = ev.get(1)->id();
+      pairs.emplace(std::min(v0, v1), std::max(v0, v1));
+    }
+    REQUIRE(pairs.size() == be.size());
+    return pairs;
+  };
+  auto check = [&body, &vertex_pairs]()
+  {
+    REQUIRE(Topo::has_edge_table(body));
+    auto with_table = vertex_pairs();
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(body);
+    std::set<const Topo::IBase*> edges;
+    for (auto& edge : be)
+      edges.insert(edge.get());
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(body);
+    for (auto& face : bf)
+    {
+      Topo::Iterator<Topo::Type::FACE, Topo::Type::EDGE> fe(face);
+      for (auto& edge : fe)
+        REQUIRE(edges.count(edge.get()) == 1);
+    }
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv(body);
+    for (auto& vert : bv)
+    {
+      Topo::Iterator<Topo::Type::VERTEX, Topo::Type::EDGE> ve(vert);
+      for (auto& edge : ve)
+        REQUIRE(edges.count(edge.get()) == 1);
+    }
+    Topo::remove_edge_table(body);
+    REQUIRE(!Topo::has_edge_table(body));
+    REQUIRE(vertex_pairs() == with_table);
+    REQUIRE(Topo::add_edge_table(body));
+    return with_table.size();
+  };
+  REQUIRE(Topo::add_edge_table(body));
+  REQUIRE(check() == 12);
+  {
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be0(body), be1(body);
+    REQUIRE(be0.size() == be1.size());
+    for (size_t i = 0; i < be0.size(); ++i)
+      REQUIRE(be0.get(i).get() == be1.get(i).get());
+  }
+
+  // Split an edge in its middle.
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(body);
+  auto edge = be.get(0);
+  Geo::Segment seg;
+  edge->geom(seg);
+  Topo::Split<Topo::Type::EDGE>::Info info;
+  info.vert_.make<Topo::EE<Topo::Type::VERTEX>>();
+  info.clsst_pt_ = (seg[0] + seg[1]) / 2.;
+  info.vert_->set_geom(info.clsst_pt_);
+  info.t_ = 0.5;
+  info.dist_ = 0;
+  Topo::Split<Topo::Type::EDGE> split(edge);
+  split.add_point(info);
+  REQUIRE(split());
+  REQUIRE(check() == 13);
+
+  // Reverse a face and remove another one.
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(body);
+  REQUIRE(bf.get(1)->reverse());
+  REQUIRE(check() == 13);
+  REQUIRE(bf.get(0)->remove());
+  REQUIRE(check() == 13); // Its edges are on the other faces too.
+}
+
+TEST_CASE("edge table open body", "[Topo]")
+{
+  // The boundary edges that a face edit does not touch keep their EdgeRef.
+  Topo::Wrap<Topo::Type::BODY> body;
+  body.make<Topo::EE<Topo::Type::BODY>>();
+  Topo::Wrap<Topo::Type::FACE> face;
+  face.make<Topo::EE<Topo::Type::FACE>>();
+  body->insert_child(face.get());
+  std::vector<Topo::Wrap<Topo::Type::VERTEX>> verts(5);
+  for (size_t i = 0; i < verts.size(); ++i)
+  {
+    verts[i].make<Topo::EE<Topo::Type::VERTEX>>()->set_geom(
+      { double(i == 1 || i == 2), double(i >= 2 && i < 4), 0 });
+    if (i < 4)
+      face->insert_child(verts[i].get());
+  }
+  REQUIRE(Topo::add_edge_table(body));
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(body);
+  REQUIRE(be.size() == 4);
+  std::vector<Topo::Wrap<Topo::Type::EDGE>> old_edges(be.begin(), be.end());
+
+  // A vertex in the side from the vertex 0 to the vertex 1.
+  REQUIRE(face->insert_child(verts[4].get(), 1));
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be_new(body);
+  REQUIRE(be_new.size() == 5);
+  std::set<const Topo::IBase*> new_edges;
+  for (auto& edge : be_new)
+    new_edges.insert(edge.get());
+  size_t kept = 0;
+  for (auto& edge : old_edges)
+    kept += new_edges.count(edge.get());
+  REQUIRE(kept == 3);
+  Topo::Iterator<Topo::Type::FACE, Topo::Type::EDGE> fe(face);
+  for (auto& edge : fe)
+    REQUIRE(new_edges.count(edge.get()) == 1);
+}
+
+TEST_CASE("transaction", "[Topo]")
+{
+  Topo::Wrap<Topo::Type::BODY> body = make_cube(cube_00);
+  REQUIRE(Topo::add_half_edge_index(body));
+  REQUIRE(Topo::add_edge_table(body));
+  // The index and the table must match the ones made again.
+  auto check = [&body]()
+  {
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be(body);
+    std::set<Topo::Wrap<Topo::Type::EDGE>> edges(be.begin(), be.end());
+    REQUIRE(edges.size() == be.size());
+    Topo::remove_edge_table(body);
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::EDGE> be_new(body);
+    REQUIRE(std::set<Topo::Wrap<Topo::Type::EDGE>>(be_new.begin(), be_new.end()) == edges);
+    Adjacency with_index(body);
+    Topo::remove_half_edge_index(body);
+    REQUIRE(Adjacency(body) == with_index);
+    REQUIRE(Topo::add_half_edge_index(body));
+    REQUIRE(Topo::add_edge_table(body));
+    return edges.size();
+  };
+  auto new_vertex = [](const Geo::Point& _pt)
+  {
+    Topo::Wrap<Topo::Type::VERTEX> vert;
+    vert.make<Topo::EE<Topo::Type::VERTEX>>()->set_geom(_pt);
+    return vert;
+  };
+
+  // Split two edges of a face in one transaction.
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(body);
+  auto face = bf.get(0);
+  Topo::Iterator<Topo::Type::FACE, Topo::Type::EDGE> fe(face);
+  std::vector<Topo::Wrap<Topo::Type::VERTEX>> new_verts;
+  Topo::Transaction trans;
+  for (size_t i = 0; i < 2; ++i)
+  {
+    Geo::Segment seg;
+    fe.get(2 * i)->geom(seg);
+    Topo::Split<Topo::Type::EDGE>::Info info;
+    info.clsst_pt_ = (seg[0] + seg[1]) / 2.;
+    info.vert_ = new_vertex(info.clsst_pt_);
+    info.t_ = 0.5;
+    info.dist_ = 0;
+    new_verts.push_back(info.vert_);
+    auto edge = fe.get(2 * i);
+    Topo::Split<Topo::Type::EDGE> split(edge);
+    split.add_point(info);
+    REQUIRE(split(trans));
+  }
+  REQUIRE(face->size(Topo::Direction::Down) == 4);
+  REQUIRE(trans.commit());
+  REQUIRE(trans.empty());
+  REQUIRE(!trans.commit());
+  REQUIRE(face->size(Topo::Direction::Down) == 6);
+  for (const auto& vert : new_verts)
+    REQUIRE(vert->size(Topo::Direction::Up) == 2);
+  REQUIRE(check() == 14);
+
+  // Replace a vertex of the cube in all its faces.
+  Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv(face);
+  auto old_vert = *std::find_if(fv.begin(), fv.end(),
+    [](const Topo::Wrap<Topo::Type::VERTEX>& _vert)
+  {
+    return _vert->size(Topo::Direction::Up) == 3;
+  });
+  Geo::Point pt;
+  old_vert->geom(pt);
+  auto vert = new_vertex(pt);
+  trans.replace(old_vert.get(), vert.get());
+  REQUIRE(trans.commit());
+  REQUIRE(old_vert->size(Topo::Direction::Up) == 0);
+  REQUIRE(vert->size(Topo::Direction::Up) == 3);
+  REQUIRE(check() == 14);
+
+  // Remove two faces.
+  trans.remove(bf.get(0).get());
+  trans.remove(bf.get(1).get());
+  REQUIRE(trans.commit());
+  REQUIRE(body->size(Topo::Direction::Down) == 4);
+  REQUIRE(face->size(Topo::Direction::Down) == 0);
+  REQUIRE(face->size(Topo::Direction::Up) == 0);
+  for (const auto& vert : new_verts)
+    REQUIRE(vert->size(Topo::Direction::Up) == 1);
+  check();
+}
+
+TEST_CASE("compact", "[Topo]")
+{
+  // A grid of 4 x 4 quads with the points in reverse order.
+  std::vector<Geo::Point> pts;
+  for (size_t i = 25; i-- > 0;)
+    pts.push_back({ double(i % 5), double(i / 5), 0 });
+  auto pt_ind = [](size_t _x, size_t _y) { return uint32_t(24 - (5 * _y + _x)); };
+  std::vector<uint32_t> face_offs(1, 0), face_verts;
+  for (size_t y = 4; y-- > 0;)
+  {
+    for (size_t x = 4; x-- > 0;)
+    {
+      for (auto ind : { pt_ind(x, y), pt_ind(x + 1, y), pt_ind(x + 1, y + 1), pt_ind(x, y + 1) })
+        face_verts.push_back(ind);
+      face_offs.push_back(uint32_t(face_verts.size()));
+    }
+  }
+  auto mesh = Topo::make_mesh_body(pts, std::vector<double>(pts.size(), 1e-9),
+    face_offs, face_verts);
+  auto body = Topo::expand_mesh_body(mesh);
+
+  auto face_points = [](const Topo::Wrap<Topo::Type::BODY>& _body)
+  {
+    std::vector<std::vector<Geo::Point>> faces;
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(_body);
+    for (auto& face : bf)
+    {
+      faces.emplace_back();
+      Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv(face);
+      for (auto& vert : fv)
+      {
+        faces.back().emplace_back();
+        vert->geom(faces.back().back());
+      }
+    }
+    return faces;
+  };
+  // The first points and the first face are in the cell at the origin.
+  auto check = [&face_points](const Topo::Wrap<Topo::Type::BODY>& _body,
+    const std::vector<std::vector<Geo::Point>>& _faces)
+  {
+    auto faces = face_points(_body);
+    REQUIRE(std::set<std::vector<Geo::Point>>(faces.begin(), faces.end()) ==
+      std::set<std::vector<Geo::Point>>(_faces.begin(), _faces.end()));
+    for (const auto& pt : faces.front())
+      REQUIRE((pt[0] <= 1 && pt[1] <= 1));
+    Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv(_body);
+    REQUIRE(bv.size() == 25);
+  };
+
+  const auto faces = face_points(mesh);
+  REQUIRE(Topo::compact(mesh));
+  REQUIRE(mesh->sub_type() == Topo::SubType::MESH_BODY);
+  check(mesh, faces);
+  const auto& mesh_pts = static_cast<const Topo::MeshBody*>(mesh.get())->pts_;
+  for (size_t i = 0; i < 4; ++i)
+    REQUIRE((mesh_pts[i][0] <= 1 && mesh_pts[i][1] <= 1));
+
+  REQUIRE(Topo::add_half_edge_index(body));
+  REQUIRE(Topo::compact(body));
+  REQUIRE(body->sub_type() == Topo::SubType::BODY);
+  check(body, faces);
+  // The ids of the vertices follow the curve.
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::FACE> bf(body);
+  Topo::Iterator<Topo::Type::FACE, Topo::Type::VERTEX> fv(bf.get(0));
+  Topo::Iterator<Topo::Type::BODY, Topo::Type::VERTEX> bv(body);
+  for (auto& vert : fv)
+  {
+    for (auto& oth_vert : bv)
+    {
+      Geo::Point pt;
+      oth_vert->geom(pt);
+      if (pt[0] > 1 || pt[1] > 1)
+        REQUIRE(vert->id() < oth_vert->id());
+    }
+  }
+  Adjacency with_index(body);
+  Topo::remove_half_edge_index(body);
+  REQUIRE(Adjacency(body) == with_index);
+}
+
 namespace
 {
 static Topo::Wrap<Topo::Type::BODY> body_1;
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace Utils {
+
+// Hash of a couple of values, e.g. the hash of an edge from the ones of
+// its vertices.
+inline size_t hash_combine(size_t _seed, size_t _hsh)
+{
+  return _seed ^ (_hsh + 0x9E3779B97F4A7C15ull + (_seed << 6) + (_seed >> 2));
+}
+
+// Hash table with open addressing. The values are in a vector, in insertion
+// order, and the slots of a power of 2 table keep their positions + 1 (0 is a
+// free slot). The hash of every value is kept, so a lookup compares integers
+// and calls EqualT only when the hashes are the same.
+// The erase moves the last value in the place of the erased one. Insertions
+// and erasures invalidate the iterators and the references to the values.
+template <class ValueT, class KeyT, class KeyOfT, class HashT, class EqualT>
+class FlatHashTable
+{
+public:
+  typedef typename std::vector<ValueT>::iterator iterator;
+  typedef typename std::vector<ValueT>::const_iterator const_iterator;
+
+  iterator begin() { return vals_.begin(); }
+  iterator end() { return vals_.end(); }
+  const_iterator begin() const { return vals_.begin(); }
+  const_iterator end() const { return vals_.end(); }
+
+  size_t size() const { return vals_.size(); }
+  bool empty() const { return vals_.empty(); }
+
+  void clear()
+  {
+    vals_.clear();
+    hashes_.clear();
+    slots_.clear();
+  }
+
+  void reserve(size_t _n)
+  {
+    vals_.reserve(_n);
+    hashes_.reserve(_n);
+    if (2 * _n > slots_.size())
+      rehash(2 * _n);
+  }
+
+  iterator find(const KeyT& _key)
+  {
+    auto pos = locate(_key);
+    return pos == 0 ? end() : begin() + (pos - 1);
+  }
+
+  const_iterator find(const KeyT& _key) const
+  {
+    auto pos = locate(_key);
+    return pos == 0 ? end() : begin() + (pos - 1);
+  }
+
+  size_t count(const KeyT& _key) const { return locate(_key) == 0 ? 0 : 1; }
+
+  template <class... ArgsT> std::pair<iterator, bool> emplace(ArgsT&&... _args)
+  {
+    ValueT val(std::forward<ArgsT>(_args)...);
+    const auto hsh = HashT()(KeyOfT()(val));
+    if (2 * (vals_.size() + 1) > slots_.size())
+      rehash(2 * (vals_.size() + 1));
+    auto slot = probe(KeyOfT()(val), hsh);
+    if (slots_[slot] != 0)
+      return std::make_pair(begin() + (slots_[slot] - 1), false);
+    slots_[slot] = uint32_t(vals_.size() + 1);
+    vals_.push_back(std::move(val));
+    hashes_.push_back(hsh);
+    return std::make_pair(end() - 1, true);
+  }
+
+  std::pair<iterator, bool> insert(const ValueT& _val) { return emplace(_val); }
+
+  template <class IteratorT> void insert(IteratorT _beg, IteratorT _end)
+  {
+    for (; _beg != _end; ++_beg)
+      emplace(*_beg);
+  }
+
+  size_t erase(const KeyT& _key)
+  {
+    if (slots_.empty())
+      return 0;
+    auto slot = probe(_key, HashT()(_key));
+    if (slots_[slot] == 0)
+      return 0;
+    const size_t pos = slots_[slot] - 1;
+    free_slot(slot);
+    const size_t last = vals_.size() - 1;
+    if (pos != last)
+    {
+      slots_[find_slot(last)] = uint32_t(pos + 1);
+      vals_[pos] = std::move(vals_[last]);
+      hashes_[pos] = hashes_[last];
+    }
+    vals_.pop_back();
+    hashes_.pop_back();
+    return 1;
+  }
+
+private:
+  // Fibonacci hashing: the high bits of the product are good also when the
+  // hashes are ids or aligned pointers.
+  size_t home(size_t _hsh) const
+  {
+    return size_t((uint64_t(_hsh) * 0x9E3779B97F4A7C15ull) >> shift_);
+  }
+
+  size_t next(size_t _slot) const { return (_slot + 1) & (slots_.size() - 1); }
+
+  // Slot of _key, or the free slot where it goes.
+  size_t probe(const KeyT& _key, size_t _hsh) const
+  {
+    for (auto slot = home(_hsh);; slot = next(slot))
+    {
+      const auto pos = slots_[slot];
+      if (pos == 0 ||
+        (hashes_[pos - 1] == _hsh && EqualT()(KeyOfT()(vals_[pos - 1]), _key)))
+      {
+        return slot;
+      }
+    }
+  }
+
+  // Position + 1 of _key, 0 if missing.
+  size_t locate(const KeyT& _key) const
+  {
+    return slots_.empty() ? 0 : slots_[probe(_key, HashT()(_key))];
+  }
+
+  size_t find_slot(size_t _pos) const
+  {
+    auto slot = home(hashes_[_pos]);
+    while (slots_[slot] != _pos + 1)
+      slot = next(slot);
+    return slot;
+  }
+
+  // Backward shift: the next values of the cluster that can go in the free
+  // slot are moved there, so the lookups need no tombstones.
+  void free_slot(size_t _slot)
+  {
+    const auto mask = slots_.size() - 1;
+    for (auto slot = next(_slot); slots_[slot] != 0; slot = next(slot))
+    {
+      const auto hom = home(hashes_[slots_[slot] - 1]);
+      if (((slot - hom) & mask) >= ((slot - _slot) & mask))
+      {
+        slots_[_slot] = slots_[slot];
+        _slot = slot;
+      }
+    }
+    slots_[_slot] = 0;
+  }
+
+  void rehash(size_t _min_size)
+  {
+    size_t size = 16;
+    shift_ = 60;
+    while (size < _min_size)
+    {
+      size *= 2;
+      --shift_;
+    }
+    slots_.assign(size, 0);
+    for (size_t pos = 0; pos < vals_.size(); ++pos)
+    {
+      auto slot = home(hashes_[pos]);
+      while (slots_[slot] != 0)
+        slot = next(slot);
+      slots_[slot] = uint32_t(pos + 1);
+    }
+  }
+
+  std::vector<ValueT> vals_;
+  std::vector<size_t> hashes_;
+  std::vector<uint32_t> slots_;
+  unsigned shift_ = 60;
+};
+
+template <class KeyT> struct KeyOfSelf
+{
+  const KeyT& operator()(const KeyT& _key) const { return _key; }
+};
+
+template <class KeyT, class MappedT> struct KeyOfPair
+{
+  const KeyT& operator()(const std::pair<KeyT, MappedT>& _val) const
+  {
+    return _val.first;
+  }
+};
+
+template <class KeyT,
+  class HashT = std::hash<KeyT>, class EqualT = std::equal_to<KeyT>>
+class FlatHashSet :
+  public FlatHashTable<KeyT, KeyT, KeyOfSelf<KeyT>, HashT, EqualT>
+{
+};
+
+// The keys must not be changed through the iterators.
+template <class KeyT, class MappedT,
+  class HashT = std::hash<KeyT>, class EqualT = std::equal_to<KeyT>>
+class FlatHashMap : public FlatHashTable<std::pair<KeyT, MappedT>, KeyT,
+  KeyOfPair<KeyT, MappedT>, HashT, EqualT>
+{
+public:
+  MappedT& operator[](const KeyT& _key)
+  {
+    auto it = this->find(_key);
+    if (it == this->end())
+      it = this->emplace(_key, MappedT()).first;
+    return it->second;
+  }
+};
+
+}//namespace Utils
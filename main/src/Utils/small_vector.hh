@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+namespace Utils {
+
+// Vector with the first N values inline: lists that stay small cost no
+// heap block. Only for trivially copyable values, that are moved with
+// memmove.
+template <class ValueT, size_t N> class SmallVector
+{
+  static_assert(std::is_trivially_copyable<ValueT>::value,
+    "SmallVector needs trivially copyable values");
+  static_assert(N > 0, "SmallVector needs inline values");
+
+public:
+  typedef ValueT value_type;
+  typedef ValueT* iterator;
+  typedef const ValueT* const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  SmallVector() {}
+  SmallVector(const SmallVector& _oth) { assign(_oth.begin(), _oth.end()); }
+  ~SmallVector() { free(); }
+
+  SmallVector& operator=(const SmallVector& _oth)
+  {
+    if (this != &_oth)
+      assign(_oth.begin(), _oth.end());
+    return *this;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return cap_; }
+  bool is_inline() const { return data_ == inline_; }
+
+  ValueT* data() { return data_; }
+  const ValueT* data() const { return data_; }
+  ValueT& operator[](size_t _i) { return data_[_i]; }
+  const ValueT& operator[](size_t _i) const { return data_[_i]; }
+  ValueT& back() { return data_[size_ - 1]; }
+  const ValueT& back() const { return data_[size_ - 1]; }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+  void reserve(size_t _cap)
+  {
+    if (_cap <= cap_)
+      return;
+    auto data = static_cast<ValueT*>(::operator new(_cap * sizeof(ValueT)));
+    std::memcpy(data, data_, size_ * sizeof(ValueT));
+    free();
+    data_ = data;
+    cap_ = uint32_t(_cap);
+  }
+
+  void push_back(const ValueT& _val)
+  {
+    if (size_ == cap_)
+    {
+      const ValueT val(_val); // _val can be in the vector.
+      reserve(2 * cap_);
+      data_[size_++] = val;
+    }
+    else
+      data_[size_++] = _val;
+  }
+
+  iterator insert(const_iterator _pos, const ValueT& _val)
+  {
+    const size_t pos = _pos - data_;
+    const ValueT val(_val);
+    if (size_ == cap_)
+      reserve(2 * cap_);
+    std::memmove(data_ + pos + 1, data_ + pos, (size_ - pos) * sizeof(ValueT));
+    data_[pos] = val;
+    ++size_;
+    return data_ + pos;
+  }
+
+  iterator erase(const_iterator _pos)
+  {
+    const size_t pos = _pos - data_;
+    std::memmove(data_ + pos, data_ + pos + 1, (size_ - pos - 1) * sizeof(ValueT));
+    --size_;
+    return data_ + pos;
+  }
+
+  void pop_back() { --size_; }
+
+  void clear() { size_ = 0; }
+
+  template <class IteratorT> void assign(IteratorT _beg, IteratorT _end)
+  {
+    clear();
+    reserve(std::distance(_beg, _end));
+    for (; _beg != _end; ++_beg)
+      data_[size_++] = *_beg;
+  }
+
+private:
+  void free()
+  {
+    if (data_ != inline_)
+      ::operator delete(data_);
+  }
+
+  ValueT* data_ = inline_;
+  uint32_t size_ = 0;
+  uint32_t cap_ = N;
+  ValueT inline_[N];
+};
+
+}//namespace Utils